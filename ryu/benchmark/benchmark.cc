@@ -64,6 +64,67 @@ void dcv(double value) {
   builder.Finalize();
 }
 
+// Rewrites the output of d2s_buffered_n into the format of d2s_ecmascript_buffered_n. This is what
+// callers without a native ECMAScript mode have to do.
+static int d2s_to_ecmascript(const char* const in, const int length, char* const out) {
+  if (in[length - 1] == 'N' || in[length - 1] == 'y') {
+    // NaN or [-]Infinity
+    memcpy(out, in, length);
+    return length;
+  }
+  int i = 0;
+  int index = 0;
+  if (in[0] == '-') {
+    ++i;
+    if (in[1] != '0') {
+      out[index++] = '-';
+    }
+  }
+  char digits[17];
+  int olength = 0;
+  for (; in[i] != 'E'; ++i) {
+    if (in[i] != '.') {
+      digits[olength++] = in[i];
+    }
+  }
+  // The output of d2s_buffered_n is not null-terminated, so we can't use atoi here.
+  const bool negative = in[++i] == '-';
+  int exponent = 0;
+  for (i += negative; i < length; ++i) {
+    exponent = 10 * exponent + (in[i] - '0');
+  }
+  const int n = (negative ? -exponent : exponent) + 1;
+  if (olength == 1 && digits[0] == '0') {
+    out[0] = '0';
+    return 1;
+  }
+  if (n >= olength && n <= 21) {
+    memcpy(out + index, digits, olength);
+    memset(out + index + olength, '0', n - olength);
+    return index + n;
+  }
+  if (n > 0 && n <= 21) {
+    memcpy(out + index, digits, n);
+    out[index + n] = '.';
+    memcpy(out + index + n + 1, digits + n, olength - n);
+    return index + olength + 1;
+  }
+  if (n > -6 && n <= 0) {
+    out[index++] = '0';
+    out[index++] = '.';
+    memset(out + index, '0', -n);
+    memcpy(out + index - n, digits, olength);
+    return index - n + olength;
+  }
+  out[index++] = digits[0];
+  if (olength > 1) {
+    out[index++] = '.';
+    memcpy(out + index, digits + 1, olength - 1);
+    index += olength - 1;
+  }
+  return index + sprintf(out + index, "e%+d", n - 1);
+}
+
 static float int32Bits2Float(uint32_t bits) {
   float f;
   memcpy(&f, &bits, sizeof(float));
@@ -111,6 +172,10 @@ public:
   bool verbose() const { return m_verbose; }
   bool ryu_only() const { return m_ryu_only; }
   bool classic() const { return m_classic; }
+  bool batch() const { return m_batch; }
+  bool ecmascript() const { return m_ecmascript; }
+  int cache() const { return m_cache; }
+  int distinct() const { return m_distinct; }
   int small_digits() const { return m_small_digits; }
 
   void parse(const char * const arg) {
@@ -126,6 +191,24 @@ public:
       m_ryu_only = true;
     } else if (strcmp(arg, "-classic") == 0) {
       m_classic = true;
+    } else if (strcmp(arg, "-batch") == 0) {
+      m_batch = true;
+    } else if (strcmp(arg, "-ecmascript") == 0) {
+      // The ECMAScript mode is only available for 64-bit values.
+      m_run32 = false;
+      m_run64 = true;
+      m_ecmascript = true;
+    } else if (strncmp(arg, "-cache=", 7) == 0) {
+      // The cache is only benchmarked for 64-bit values.
+      m_run32 = false;
+      m_run64 = true;
+      if (sscanf(arg, "-cache=%i", &m_cache) != 1 || m_cache < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-distinct=", 10) == 0) {
+      if (sscanf(arg, "-distinct=%i", &m_distinct) != 1 || m_distinct < 1) {
+        fail(arg);
+      }
     } else if (strncmp(arg, "-samples=", 9) == 0) {
       if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
         fail(arg);
@@ -157,6 +240,10 @@ private:
   bool m_verbose = false;
   bool m_ryu_only = false;
   bool m_classic = false;
+  bool m_batch = false;
+  bool m_ecmascript = false;
+  int m_cache = 0;
+  int m_distinct = 0;
   int m_small_digits = 0;
 };
 
@@ -244,6 +331,12 @@ static int bench32(const benchmark_options& options) {
       uint32_t r = 0;
       vec[i] = generate_float(options, mt32, r);
     }
+    std::vector<char> batch_output;
+    std::vector<int> batch_offsets;
+    if (options.batch()) {
+      batch_output.resize(15 * vec.size());
+      batch_offsets.resize(vec.size() + 1);
+    }
 
     for (int j = 0; j < options.iterations(); ++j) {
       auto t1 = steady_clock::now();
@@ -256,7 +349,13 @@ static int bench32(const benchmark_options& options) {
       mv1.update(delta1);
 
       double delta2 = 0.0;
-      if (!options.ryu_only()) {
+      if (options.batch()) {
+        t1 = steady_clock::now();
+        throwaway += f2s_batch(vec.data(), options.samples(), batch_output.data(), batch_offsets.data());
+        t2 = steady_clock::now();
+        delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
+        mv2.update(delta2);
+      } else if (!options.ryu_only()) {
         t1 = steady_clock::now();
         for (int i = 0; i < options.samples(); ++i) {
           fcv(vec[i]);
@@ -268,7 +367,7 @@ static int bench32(const benchmark_options& options) {
       }
 
       if (options.verbose()) {
-        if (options.ryu_only()) {
+        if (options.ryu_only() && !options.batch()) {
           printf("%f\n", delta1);
         } else {
           printf("%f,%f\n", delta1, delta2);
@@ -278,7 +377,7 @@ static int bench32(const benchmark_options& options) {
   }
   if (!options.verbose()) {
     printf("32: %8.3f %8.3f", mv1.mean, mv1.stddev());
-    if (!options.ryu_only()) {
+    if (!options.ryu_only() || options.batch()) {
       printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
     }
     printf("\n");
@@ -308,6 +407,7 @@ static int bench64(const benchmark_options& options) {
   std::mt19937 mt32(12345);
   mean_and_variance mv1;
   mean_and_variance mv2;
+  double cache_hit_rate = 0.0;
   int throwaway = 0;
   if (options.classic()) {
     for (int i = 0; i < options.samples(); ++i) {
@@ -349,23 +449,90 @@ static int bench64(const benchmark_options& options) {
     }
   } else {
     std::vector<double> vec(options.samples());
-    for (int i = 0; i < options.samples(); ++i) {
-      uint64_t r = 0;
-      vec[i] = generate_double(options, mt32, r);
+    if (options.distinct() > 0) {
+      // Draw the samples from a pool of distinct values with a skewed distribution: the i-th value
+      // is picked with a probability proportional to roughly 1 / i^(2/3).
+      std::vector<double> pool(options.distinct());
+      for (int i = 0; i < options.distinct(); ++i) {
+        uint64_t r = 0;
+        pool[i] = generate_double(options, mt32, r);
+      }
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      for (int i = 0; i < options.samples(); ++i) {
+        const double u = uniform(mt32);
+        vec[i] = pool[static_cast<int>(options.distinct() * u * u * u)];
+      }
+    } else {
+      for (int i = 0; i < options.samples(); ++i) {
+        uint64_t r = 0;
+        vec[i] = generate_double(options, mt32, r);
+      }
+    }
+    ryu_cache* cache = nullptr;
+    if (options.cache() > 0) {
+      cache = ryu_cache_new(options.cache());
+    }
+    std::vector<char> batch_output;
+    std::vector<int> batch_offsets;
+    if (options.batch()) {
+      batch_output.resize(24 * vec.size());
+      batch_offsets.resize(vec.size() + 1);
+    }
+    if (options.ecmascript()) {
+      char expected[BUFFER_SIZE];
+      for (int i = 0; i < options.samples(); ++i) {
+        const int n1 = d2s_to_ecmascript(bufferown, d2s_buffered_n(vec[i], bufferown), expected);
+        const int n2 = d2s_ecmascript_buffered_n(vec[i], bufferown);
+        if (n1 != n2 || memcmp(expected, bufferown, n1) != 0) {
+          printf("For %.17g %.*s %.*s\n", vec[i], n1, expected, n2, bufferown);
+        }
+      }
     }
 
     for (int j = 0; j < options.iterations(); ++j) {
       auto t1 = steady_clock::now();
-      for (int i = 0; i < options.samples(); ++i) {
-        d2s_buffered(vec[i], bufferown);
-        throwaway += bufferown[2];
+      if (options.ecmascript()) {
+        char reformatted[BUFFER_SIZE];
+        for (int i = 0; i < options.samples(); ++i) {
+          d2s_to_ecmascript(bufferown, d2s_buffered_n(vec[i], bufferown), reformatted);
+          throwaway += reformatted[2];
+        }
+      } else {
+        for (int i = 0; i < options.samples(); ++i) {
+          d2s_buffered(vec[i], bufferown);
+          throwaway += bufferown[2];
+        }
       }
       auto t2 = steady_clock::now();
       double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
       mv1.update(delta1);
 
       double delta2 = 0.0;
-      if (!options.ryu_only()) {
+      if (cache != nullptr) {
+        t1 = steady_clock::now();
+        for (int i = 0; i < options.samples(); ++i) {
+          d2s_cached_buffered_n(cache, vec[i], bufferown);
+          throwaway += bufferown[2];
+        }
+        t2 = steady_clock::now();
+        delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
+        mv2.update(delta2);
+      } else if (options.ecmascript()) {
+        t1 = steady_clock::now();
+        for (int i = 0; i < options.samples(); ++i) {
+          d2s_ecmascript_buffered_n(vec[i], bufferown);
+          throwaway += bufferown[2];
+        }
+        t2 = steady_clock::now();
+        delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
+        mv2.update(delta2);
+      } else if (options.batch()) {
+        t1 = steady_clock::now();
+        throwaway += d2s_batch(vec.data(), options.samples(), batch_output.data(), batch_offsets.data());
+        t2 = steady_clock::now();
+        delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
+        mv2.update(delta2);
+      } else if (!options.ryu_only()) {
         t1 = steady_clock::now();
         for (int i = 0; i < options.samples(); ++i) {
           dcv(vec[i]);
@@ -377,20 +544,28 @@ static int bench64(const benchmark_options& options) {
       }
 
       if (options.verbose()) {
-        if (options.ryu_only()) {
+        if (options.ryu_only() && !options.batch() && !options.ecmascript() && cache == nullptr) {
           printf("%f\n", delta1);
         } else {
           printf("%f,%f\n", delta1, delta2);
         }
       }
     }
+    if (cache != nullptr) {
+      const ryu_cache_stats stats = ryu_cache_get_stats(cache);
+      cache_hit_rate = 100.0 * stats.hits / (stats.hits + stats.misses);
+      ryu_cache_free(cache);
+    }
   }
   if (!options.verbose()) {
     printf("64: %8.3f %8.3f", mv1.mean, mv1.stddev());
-    if (!options.ryu_only()) {
+    if (!options.ryu_only() || options.batch() || options.ecmascript() || options.cache() > 0) {
       printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
     }
     printf("\n");
+    if (options.cache() > 0) {
+      printf("Cache hit rate: %.2f%%\n", cache_hit_rate);
+    }
   }
   return throwaway;
 }
@@ -417,7 +592,41 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
   }
 
-  if (options.verbose()) {
+  if ((options.batch() ? 1 : 0) + (options.ecmascript() ? 1 : 0) + (options.cache() > 0 ? 1 : 0) > 1) {
+    printf("Only one of -batch, -ecmascript, and -cache=n can be used.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (options.cache() > 0) {
+    if (options.classic()) {
+      printf("The -cache option cannot be combined with -classic.\n");
+      exit(EXIT_FAILURE);
+    }
+    if (options.verbose()) {
+      printf("ryu_time_in_ns,ryu_cached_time_in_ns\n");
+    } else {
+      printf("    Average & Stddev Ryu  Average & Stddev Ryu Cached\n");
+    }
+  } else if (options.ecmascript()) {
+    if (options.classic()) {
+      printf("The -ecmascript option cannot be combined with -classic.\n");
+      exit(EXIT_FAILURE);
+    }
+    if (options.verbose()) {
+      printf("ryu_reformat_time_in_ns,ryu_ecmascript_time_in_ns\n");
+    } else {
+      printf("    Average & Stddev Ryu+Reformat  Average & Stddev Ryu ECMAScript\n");
+    }
+  } else if (options.batch()) {
+    if (options.classic()) {
+      printf("The -batch option cannot be combined with -classic.\n");
+      exit(EXIT_FAILURE);
+    }
+    if (options.verbose()) {
+      printf("ryu_time_in_ns,ryu_batch_time_in_ns\n");
+    } else {
+      printf("    Average & Stddev Ryu  Average & Stddev Ryu Batch\n");
+    }
+  } else if (options.verbose()) {
     printf("%sryu_time_in_ns%s\n", options.classic() ? "ryu_output,float_bits_as_int," : "", options.ryu_only() ? "" : ",grisu3_time_in_ns");
   } else {
     printf("    Average & Stddev Ryu%s\n", options.ryu_only() ? "" : "  Average & Stddev Grisu3");
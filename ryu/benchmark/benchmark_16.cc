@@ -0,0 +1,198 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Compares h2s and bf2s against generic_binary_to_decimal from generic_128, and against widening
+// to float and calling f2s.
+
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_generic_128.h"
+
+using namespace std::chrono;
+
+constexpr int BUFFER_SIZE = 64;
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+struct format_16 {
+  const char* name;
+  uint32_t mantissaBits;
+  uint32_t exponentBits;
+  int (*to_string)(uint16_t, char*);
+  int (*batch)(const uint16_t*, int, char*, int*);
+  float (*widen)(uint16_t);
+};
+
+static float half_to_float(const uint16_t h) {
+  // Scale the mantissa and exponent into place; the float exponent range covers all half values.
+  const uint32_t exponent = (h >> 10) & 0x1f;
+  const uint32_t mantissa = h & 0x3ff;
+  float f;
+  if (exponent == 0x1f) {
+    f = mantissa != 0 ? NAN : INFINITY;
+  } else if (exponent == 0) {
+    f = ldexpf((float) mantissa, -24);
+  } else {
+    f = ldexpf((float) (mantissa | 0x400), (int) exponent - 25);
+  }
+  return (h & 0x8000) != 0 ? -f : f;
+}
+
+static float bfloat16_to_float(const uint16_t bf) {
+  const uint32_t bits = (uint32_t) bf << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static int generic_16(const uint16_t bits, const format_16& format, char* const result) {
+  return generic_to_chars(generic_binary_to_decimal(bits, format.mantissaBits, format.exponentBits, false), result);
+}
+
+static double elapsed(const steady_clock::time_point t1, const steady_clock::time_point t2, const int samples) {
+  return duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(samples);
+}
+
+static int bench16(const format_16& format, const int samples, const int iterations) {
+  char bufferown[BUFFER_SIZE];
+  std::mt19937 mt32(12345);
+  mean_and_variance mv[4];
+  int throwaway = 0;
+
+  std::vector<uint16_t> vec(samples);
+  std::vector<float> widened(samples);
+  for (int i = 0; i < samples; ++i) {
+    vec[i] = (uint16_t) mt32();
+    widened[i] = format.widen(vec[i]);
+  }
+  std::vector<char> batch_output(10 * samples);
+  std::vector<int> batch_offsets(samples + 1);
+
+  for (int j = 0; j < iterations; ++j) {
+    auto t1 = steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+      throwaway += format.to_string(vec[i], bufferown);
+    }
+    auto t2 = steady_clock::now();
+    mv[0].update(elapsed(t1, t2, samples));
+
+    t1 = steady_clock::now();
+    throwaway += format.batch(vec.data(), samples, batch_output.data(), batch_offsets.data());
+    t2 = steady_clock::now();
+    mv[1].update(elapsed(t1, t2, samples));
+
+    t1 = steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+      throwaway += generic_16(vec[i], format, bufferown);
+    }
+    t2 = steady_clock::now();
+    mv[2].update(elapsed(t1, t2, samples));
+
+    t1 = steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+      throwaway += f2s_buffered_n(widened[i], bufferown);
+    }
+    t2 = steady_clock::now();
+    mv[3].update(elapsed(t1, t2, samples));
+  }
+
+  printf("%-8s", format.name);
+  for (int k = 0; k < 4; ++k) {
+    printf(" %8.3f %8.3f", mv[k].mean, mv[k].stddev());
+  }
+  printf("\n");
+  return throwaway;
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  int samples = 10000;
+  int iterations = 1000;
+  for (int i = 1; i < argc; ++i) {
+    const char* const arg = argv[i];
+    if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &samples) != 1 || samples < 1) {
+        printf("Unrecognized option '%s'.\n", arg);
+        exit(EXIT_FAILURE);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &iterations) != 1 || iterations < 1) {
+        printf("Unrecognized option '%s'.\n", arg);
+        exit(EXIT_FAILURE);
+      }
+    } else {
+      printf("Unrecognized option '%s'.\n", arg);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  setbuf(stdout, NULL);
+  printf("         Average & Stddev Ryu  Average & Stddev Batch  Average & Stddev Generic128  Average & Stddev f2s\n");
+  const format_16 half = { "half", 10, 5, h2s_buffered_n, h2s_batch, half_to_float };
+  const format_16 bfloat16 = { "bfloat16", 7, 8, bf2s_buffered_n, bf2s_batch, bfloat16_to_float };
+  int throwaway = 0;
+  throwaway += bench16(half, samples, iterations);
+  throwaway += bench16(bfloat16, samples, iterations);
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%d\n", throwaway);
+  }
+  return 0;
+}
@@ -17,10 +17,13 @@
 
 #include <math.h>
 #include <inttypes.h>
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <string.h>
 #include <chrono>
 #include <random>
+#include <vector>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,6 +39,12 @@ using namespace std::chrono;
 
 constexpr int BUFFER_SIZE = 2000;
 
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
 static double int64Bits2Double(uint64_t bits) {
   double f;
   memcpy(&f, &bits, sizeof(double));
@@ -72,27 +81,51 @@ public:
 
   bool run32() const { return m_run32; }
   bool run64() const { return m_run64; }
+  bool run_general() const { return m_run_general; }
   int samples() const { return m_samples; }
   int iterations() const { return m_iterations; }
   bool verbose() const { return m_verbose; }
   bool ryu_only() const { return m_ryu_only; }
   bool classic() const { return m_classic; }
+  bool run_float() const { return m_float; }
   int small_digits() const { return m_small_digits; }
   int precision() const { return m_precision; }
+  bool sweep() const { return m_sweep; }
+  bool cold() const { return m_cold; }
+  bool csv() const { return m_csv; }
+  int rows() const { return m_rows; }
 
   void parse(const char * const arg) {
     if (strcmp(arg, "-f") == 0) {
       m_run32 = false;
       m_run64 = true;
+      m_run_general = false;
     } else if (strcmp(arg, "-e") == 0) {
       m_run32 = true;
       m_run64 = false;
+      m_run_general = false;
+    } else if (strcmp(arg, "-g") == 0) {
+      m_run32 = false;
+      m_run64 = false;
+      m_run_general = true;
     } else if (strcmp(arg, "-v") == 0) {
       m_verbose = true;
     } else if (strcmp(arg, "-ryu") == 0) {
       m_ryu_only = true;
     } else if (strcmp(arg, "-classic") == 0) {
       m_classic = true;
+    } else if (strcmp(arg, "-float") == 0) {
+      m_float = true;
+    } else if (strcmp(arg, "-sweep") == 0) {
+      m_sweep = true;
+    } else if (strcmp(arg, "-cold") == 0) {
+      m_cold = true;
+    } else if (strcmp(arg, "-csv") == 0) {
+      m_csv = true;
+    } else if (strncmp(arg, "-rows=", 6) == 0) {
+      if (sscanf(arg, "-rows=%i", &m_rows) != 1 || m_rows < 1) {
+        fail(arg);
+      }
     } else if (strncmp(arg, "-samples=", 9) == 0) {
       if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
         fail(arg);
@@ -123,13 +156,19 @@ private:
   // By default, run both 32 and 64-bit benchmarks with 10000 samples and 1000 iterations each.
   bool m_run32 = true;
   bool m_run64 = true;
+  bool m_run_general = false;
   int m_samples = 10000;
   int m_iterations = 1000;
   bool m_verbose = false;
   bool m_ryu_only = false;
   bool m_classic = true;
+  bool m_float = false;
   int m_small_digits = 0;
   int m_precision = 6;
+  bool m_sweep = false;
+  bool m_cold = false;
+  bool m_csv = false;
+  int m_rows = 10000000;
 };
 
 // returns 10^x
@@ -160,11 +199,91 @@ double generate_double(const benchmark_options& options, std::mt19937& mt32, uin
   return r / static_cast<double>(lower);
 }
 
+float generate_float(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  r = mt32();
+
+  if (options.small_digits() == 0) {
+    float f = int32Bits2Float(static_cast<uint32_t>(r));
+    return f;
+  }
+
+  // see example in generate_float() in benchmark.cc
+  const uint32_t lower = exp10(options.small_digits() - 1);
+  const uint32_t upper = lower * 10;
+  r = r % (upper - lower) + lower; // slightly biased, but reproducible
+  return r / static_cast<float>(lower);
+}
+
+static void generate(const benchmark_options& options, std::mt19937& mt32, uint64_t& r, double& d) {
+  d = generate_double(options, mt32, r);
+}
+
+static void generate(const benchmark_options& options, std::mt19937& mt32, uint64_t& r, float& f) {
+  f = generate_float(options, mt32, r);
+}
+
+static void ryu_fixed(const double d, const uint32_t precision, char* const result) {
+  d2fixed_buffered(d, precision, result);
+}
+
+static void ryu_fixed(const float f, const uint32_t precision, char* const result) {
+  f2fixed_buffered(f, precision, result);
+}
+
+static void ryu_exp(const double d, const uint32_t precision, char* const result) {
+  d2exp_buffered(d, precision, result);
+}
+
+static void ryu_exp(const float f, const uint32_t precision, char* const result) {
+  f2exp_buffered(f, precision, result);
+}
+
 static char bufferown[BUFFER_SIZE];
 static char buffer[BUFFER_SIZE];
 
-static int bench64_fixed(const benchmark_options& options) {
-  int precision = options.precision();
+// Larger than the last level cache of common machines.
+constexpr size_t EVICT_SIZE = 64 * 1024 * 1024;
+static char* evict_buffer;
+
+// Replaces the contents of the caches, including the lookup tables, with unrelated data.
+static int evict_caches() {
+  if (evict_buffer == nullptr) {
+    evict_buffer = static_cast<char*>(calloc(EVICT_SIZE, 1));
+  }
+  int sum = 0;
+  for (size_t i = 0; i < EVICT_SIZE; i += 64) {
+    evict_buffer[i] += 1;
+    sum += evict_buffer[i];
+  }
+  return sum;
+}
+
+// Returns the average time of options.iterations() calls of f in nanoseconds. With -cold, evicts
+// the caches before each call, and only measures the call itself.
+template <typename F>
+static double time_calls(const benchmark_options& options, int& throwaway, F f) {
+  if (!options.cold()) {
+    auto t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += f();
+    }
+    auto t2 = steady_clock::now();
+    return duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+  }
+  int64_t total = 0;
+  for (int j = 0; j < options.iterations(); ++j) {
+    throwaway += evict_caches();
+    auto t1 = steady_clock::now();
+    throwaway += f();
+    auto t2 = steady_clock::now();
+    total += duration_cast<nanoseconds>(t2 - t1).count();
+  }
+  return total / static_cast<double>(options.iterations());
+}
+
+// T is double or float. snprintf always gets a double, as floats are promoted to double.
+template <typename T>
+static int bench_fixed(const benchmark_options& options, const int precision) {
   char fmt[100];
   snprintf(fmt, 100, "%%.%df", precision);
 
@@ -174,27 +293,22 @@ static int bench64_fixed(const benchmark_options& options) {
   int throwaway = 0;
   for (int i = 0; i < options.samples(); ++i) {
     uint64_t r = 0;
-    const double f = generate_double(options, mt32, r);
+    T f;
+    generate(options, mt32, r, f);
 
 //    printf("%f\n", f);
-    auto t1 = steady_clock::now();
-    for (int j = 0; j < options.iterations(); ++j) {
-      d2fixed_buffered(f, static_cast<uint32_t>(precision), bufferown);
-      throwaway += bufferown[2];
-    }
-    auto t2 = steady_clock::now();
-    double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    double delta1 = time_calls(options, throwaway, [&] {
+      ryu_fixed(f, static_cast<uint32_t>(precision), bufferown);
+      return bufferown[2];
+    });
     mv1.update(delta1);
 
     double delta2 = 0.0;
     if (!options.ryu_only()) {
-      t1 = steady_clock::now();
-      for (int j = 0; j < options.iterations(); ++j) {
+      delta2 = time_calls(options, throwaway, [&] {
         snprintf(buffer, BUFFER_SIZE, fmt, f);
-        throwaway += buffer[2];
-      }
-      t2 = steady_clock::now();
-      delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+        return buffer[2];
+      });
       mv2.update(delta2);
     }
 
@@ -212,7 +326,12 @@ static int bench64_fixed(const benchmark_options& options) {
     }
   }
   if (!options.verbose()) {
-    printf("%%f: %8.3f %8.3f", mv1.mean, mv1.stddev());
+    if (options.sweep()) {
+      printf("%%.%df:%*s", precision, precision < 10 ? 2 : 1, "");
+    } else {
+      printf("%%f: ");
+    }
+    printf("%8.3f %8.3f", mv1.mean, mv1.stddev());
     if (!options.ryu_only()) {
       printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
     }
@@ -221,8 +340,8 @@ static int bench64_fixed(const benchmark_options& options) {
   return throwaway;
 }
 
-static int bench64_exp(const benchmark_options& options) {
-  int precision = options.precision();
+template <typename T>
+static int bench_exp(const benchmark_options& options, const int precision) {
   char fmt[100];
   snprintf(fmt, 100, "%%.%de", precision);
 
@@ -232,27 +351,22 @@ static int bench64_exp(const benchmark_options& options) {
   int throwaway = 0;
   for (int i = 0; i < options.samples(); ++i) {
     uint64_t r = 0;
-    const double f = generate_double(options, mt32, r);
+    T f;
+    generate(options, mt32, r, f);
 
 //    printf("%f\n", f);
-    auto t1 = steady_clock::now();
-    for (int j = 0; j < options.iterations(); ++j) {
-      d2exp_buffered(f, static_cast<uint32_t>(precision), bufferown);
-      throwaway += bufferown[2];
-    }
-    auto t2 = steady_clock::now();
-    double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    double delta1 = time_calls(options, throwaway, [&] {
+      ryu_exp(f, static_cast<uint32_t>(precision), bufferown);
+      return bufferown[2];
+    });
     mv1.update(delta1);
 
     double delta2 = 0.0;
     if (!options.ryu_only()) {
-      t1 = steady_clock::now();
-      for (int j = 0; j < options.iterations(); ++j) {
+      delta2 = time_calls(options, throwaway, [&] {
         snprintf(buffer, BUFFER_SIZE, fmt, f);
-        throwaway += buffer[2];
-      }
-      t2 = steady_clock::now();
-      delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+        return buffer[2];
+      });
       mv2.update(delta2);
     }
 
@@ -270,7 +384,12 @@ static int bench64_exp(const benchmark_options& options) {
     }
   }
   if (!options.verbose()) {
-    printf("%%e: %8.3f %8.3f", mv1.mean, mv1.stddev());
+    if (options.sweep()) {
+      printf("%%.%de:%*s", precision, precision < 10 ? 2 : 1, "");
+    } else {
+      printf("%%e: ");
+    }
+    printf("%8.3f %8.3f", mv1.mean, mv1.stddev());
     if (!options.ryu_only()) {
       printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
     }
@@ -279,6 +398,165 @@ static int bench64_exp(const benchmark_options& options) {
   return throwaway;
 }
 
+// %g is only implemented for doubles.
+static int bench_general(const benchmark_options& options, const int precision) {
+  char fmt[100];
+  snprintf(fmt, 100, "%%.%dg", precision);
+
+  std::mt19937 mt32(12345);
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int i = 0; i < options.samples(); ++i) {
+    uint64_t r = 0;
+    double f;
+    generate(options, mt32, r, f);
+
+    double delta1 = time_calls(options, throwaway, [&] {
+      d2general_buffered(f, static_cast<uint32_t>(precision), 0, bufferown);
+      return bufferown[2];
+    });
+    mv1.update(delta1);
+
+    double delta2 = 0.0;
+    if (!options.ryu_only()) {
+      delta2 = time_calls(options, throwaway, [&] {
+        snprintf(buffer, BUFFER_SIZE, fmt, f);
+        return buffer[2];
+      });
+      mv2.update(delta2);
+    }
+
+    if (options.verbose()) {
+      if (options.ryu_only()) {
+        printf("%s,%" PRIu64 ",%f\n", bufferown, r, delta1);
+      } else {
+        printf("%s,%" PRIu64 ",%f,%f\n", bufferown, r, delta1, delta2);
+      }
+    }
+
+    if (!options.ryu_only() && !options.verbose() && strcmp(bufferown, buffer) != 0) {
+      printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
+    }
+  }
+  if (!options.verbose()) {
+    if (options.sweep()) {
+      printf("%%.%dg:%*s", precision, precision < 10 ? 2 : 1, "");
+    } else {
+      printf("%%g: ");
+    }
+    printf("%8.3f %8.3f", mv1.mean, mv1.stddev());
+    if (!options.ryu_only()) {
+      printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+    }
+    printf("\n");
+  }
+  return throwaway;
+}
+
+// The number of rows that the CSV benchmark formats at a time.
+constexpr int CSV_CHUNK_ROWS = 1024;
+
+// Appends the chunk of rows as lines to csv, and returns the new length. A real export would write
+// the buffer to a file at this point.
+static int append_lines(const char* const fields, const int* const offsets, const int count, char* const csv) {
+  int index = 0;
+  for (int i = 0; i < count; ++i) {
+    const int length = offsets[i + 1] - offsets[i];
+    memcpy(csv + index, fields + offsets[i], length);
+    index += length;
+    csv[index++] = '\n';
+  }
+  return index;
+}
+
+// Exports a column of options.rows() doubles as CSV with one value per line, formatted with %f (or
+// %e) and the given precision. Compares snprintf, one d2fixed_buffered_n call per value, and
+// d2fixed_batch on chunks of CSV_CHUNK_ROWS values.
+static int bench_csv(const benchmark_options& options, const int precision, const bool exp) {
+  const uint32_t p = static_cast<uint32_t>(precision);
+  char fmt[100];
+  snprintf(fmt, 100, exp ? "%%.%de\n" : "%%.%df\n", precision);
+
+  // Without -small_digits, use values with up to 8 significant digits around 0, like prices or
+  // measurements, rather than random bit patterns.
+  std::mt19937 mt32(12345);
+  std::vector<double> values(options.rows());
+  for (double& value : values) {
+    uint64_t r = 0;
+    value = options.small_digits() == 0
+      ? (mt32() % 100000000) / 10000.0 - 5000.0
+      : generate_double(options, mt32, r);
+  }
+
+  const size_t maxField = (exp ? 9 : 311) + p;
+  std::vector<char> fields(maxField * CSV_CHUNK_ROWS);
+  std::vector<int> offsets(CSV_CHUNK_ROWS + 1);
+  std::vector<char> csv((maxField + 1) * CSV_CHUNK_ROWS);
+  std::vector<char> expected((maxField + 1) * CSV_CHUNK_ROWS);
+  int throwaway = 0;
+  int64_t bytes = 0;
+
+  // Each of these formats count rows starting at begin into csv, and returns the length.
+  const std::function<int(int, int)> batch = [&](const int begin, const int count) {
+    if (exp) {
+      d2exp_batch(values.data() + begin, count, p, fields.data(), offsets.data());
+    } else {
+      d2fixed_batch(values.data() + begin, count, p, fields.data(), offsets.data());
+    }
+    return append_lines(fields.data(), offsets.data(), count, csv.data());
+  };
+  const std::function<int(int, int)> single = [&](const int begin, const int count) {
+    int index = 0;
+    for (int i = begin; i < begin + count; ++i) {
+      index += exp
+        ? d2exp_buffered_n(values[i], p, csv.data() + index)
+        : d2fixed_buffered_n(values[i], p, csv.data() + index);
+      csv[index++] = '\n';
+    }
+    return index;
+  };
+  const std::function<int(int, int)> libc = [&](const int begin, const int count) {
+    int index = 0;
+    for (int i = begin; i < begin + count; ++i) {
+      index += snprintf(csv.data() + index, maxField + 1, fmt, values[i]);
+    }
+    return index;
+  };
+
+  // Check that all methods produce the same output.
+  for (int begin = 0; begin < options.rows(); begin += 100 * CSV_CHUNK_ROWS) {
+    const int count = std::min(CSV_CHUNK_ROWS, options.rows() - begin);
+    const int n = single(begin, count);
+    memcpy(expected.data(), csv.data(), n);
+    if (batch(begin, count) != n || memcmp(expected.data(), csv.data(), n) != 0) {
+      printf("Batch output differs from single output in the chunk at %d.\n", begin);
+    }
+    if (!options.ryu_only() && (libc(begin, count) != n || memcmp(expected.data(), csv.data(), n) != 0)) {
+      printf("snprintf output differs from Ryu output in the chunk at %d.\n", begin);
+    }
+  }
+
+  const auto run = [&](const char* const name, const std::function<int(int, int)>& f) {
+    auto t1 = steady_clock::now();
+    bytes = 0;
+    for (int begin = 0; begin < options.rows(); begin += CSV_CHUNK_ROWS) {
+      const int n = f(begin, std::min(CSV_CHUNK_ROWS, options.rows() - begin));
+      throwaway += csv[n / 2];
+      bytes += n;
+    }
+    auto t2 = steady_clock::now();
+    const double ns = static_cast<double>(duration_cast<nanoseconds>(t2 - t1).count());
+    printf("%%%c %-16s %8.3f ns/row %8.1f MB/s\n", exp ? 'e' : 'f', name, ns / options.rows(), bytes * 1000.0 / ns);
+  };
+  run("d2*_batch", batch);
+  run("d2*_buffered_n", single);
+  if (!options.ryu_only()) {
+    run("snprintf", libc);
+  }
+  return throwaway;
+}
+
 int main(int argc, char** argv) {
 #if defined(__linux__)
   // Also disable hyperthreading with something like this:
@@ -306,17 +584,44 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
   }
 
+  if (options.csv()) {
+    int throwaway = 0;
+    if (options.run64()) {
+      throwaway += bench_csv(options, options.precision(), false);
+    }
+    if (options.run32()) {
+      throwaway += bench_csv(options, options.precision(), true);
+    }
+    if (argc == 1000) {
+      printf("%d\n", throwaway);
+    }
+    return 0;
+  }
+
   if (options.verbose()) {
     printf("ryu_output,float_bits_as_int,ryu_time_in_ns%s\n", options.ryu_only() ? "" : ",snprintf_time_in_ns");
   } else {
-    printf("    Average & Stddev Ryu%s\n", options.ryu_only() ? "" : "  Average & Stddev snprintf");
+    printf("%s    Average & Stddev Ryu%s\n", options.sweep() ? "   " : "", options.ryu_only() ? "" : "  Average & Stddev snprintf");
   }
   int throwaway = 0;
+  // With -sweep, run every precision from 0 to 20 instead of just the given one; the fast path for
+  // precision <= 17 shows up as a step in the timings.
+  const int minPrecision = options.sweep() ? 0 : options.precision();
+  const int maxPrecision = options.sweep() ? 20 : options.precision();
   if (options.run64()) {
-    throwaway += bench64_fixed(options);
+    for (int precision = minPrecision; precision <= maxPrecision; ++precision) {
+      throwaway += options.run_float() ? bench_fixed<float>(options, precision) : bench_fixed<double>(options, precision);
+    }
   }
   if (options.run32()) {
-    throwaway += bench64_exp(options);
+    for (int precision = minPrecision; precision <= maxPrecision; ++precision) {
+      throwaway += options.run_float() ? bench_exp<float>(options, precision) : bench_exp<double>(options, precision);
+    }
+  }
+  if (options.run_general()) {
+    for (int precision = minPrecision; precision <= maxPrecision; ++precision) {
+      throwaway += bench_general(options, precision);
+    }
   }
   if (argc == 1000) {
     // Prevent the compiler from optimizing the code away.
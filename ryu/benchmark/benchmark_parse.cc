@@ -0,0 +1,247 @@
+// Copyright 2019 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Compares s2f and s2d against strtof and strtod for inputs with different numbers of significant
+// digits: the shortest representation from f2s or d2s, and random values printed with %.*e. Also
+// checks that both return the same value.
+
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+
+using namespace std::chrono;
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static double int64Bits2Double(uint64_t bits) {
+  double d;
+  memcpy(&d, &bits, sizeof(double));
+  return d;
+}
+
+static void random_value(std::mt19937& mt32, float* const f) {
+  *f = int32Bits2Float(mt32());
+}
+
+static void random_value(std::mt19937& mt32, double* const d) {
+  const uint64_t hi = mt32();
+  *d = int64Bits2Double((hi << 32) | mt32());
+}
+
+static void shortest(const float f, char* const buffer) {
+  f2s_buffered(f, buffer);
+}
+
+static void shortest(const double d, char* const buffer) {
+  d2s_buffered(d, buffer);
+}
+
+static enum Status ryu_parse(const std::string& s, float* const f) {
+  return s2f_n(s.data(), (int) s.size(), f);
+}
+
+static enum Status ryu_parse(const std::string& s, double* const d) {
+  return s2d_n(s.data(), (int) s.size(), d);
+}
+
+static void libc_parse(const std::string& s, float* const f) {
+  *f = strtof(s.c_str(), nullptr);
+}
+
+static void libc_parse(const std::string& s, double* const d) {
+  *d = strtod(s.c_str(), nullptr);
+}
+
+static double elapsed(const steady_clock::time_point t1, const steady_clock::time_point t2, const int samples) {
+  return duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(samples);
+}
+
+// Returns samples random finite floats or doubles, formatted with the given number of significant
+// digits, or with f2s or d2s if digits is 0.
+template <typename T>
+static std::vector<std::string> generate(const int digits, const int samples) {
+  std::mt19937 mt32(12345);
+  std::vector<std::string> vec;
+  vec.reserve(samples);
+  char buffer[1024];
+  while ((int) vec.size() < samples) {
+    T value;
+    random_value(mt32, &value);
+    if (!isfinite(value)) {
+      continue;
+    }
+    if (digits == 0) {
+      shortest(value, buffer);
+    } else {
+      snprintf(buffer, sizeof(buffer), "%.*e", digits - 1, (double) value);
+    }
+    vec.emplace_back(buffer);
+  }
+  return vec;
+}
+
+template <typename T>
+static int bench(const int digits, const int samples, const int iterations) {
+  const std::vector<std::string> vec = generate<T>(digits, samples);
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  int mismatches = 0;
+  for (const std::string& s : vec) {
+    T ryu;
+    const enum Status status = ryu_parse(s, &ryu);
+    T expected;
+    libc_parse(s, &expected);
+    if (status != SUCCESS || memcmp(&ryu, &expected, sizeof(T)) != 0) {
+      if (mismatches++ < 10) {
+        printf("Mismatch for %s: status %d, %.17g vs %.17g\n", s.c_str(), (int) status, (double) ryu, (double) expected);
+      }
+    }
+  }
+
+  for (int j = 0; j < iterations; ++j) {
+    auto t1 = steady_clock::now();
+    for (const std::string& s : vec) {
+      T value;
+      throwaway += ryu_parse(s, &value);
+      throwaway += value > 1;
+    }
+    auto t2 = steady_clock::now();
+    mv1.update(elapsed(t1, t2, samples));
+
+    t1 = steady_clock::now();
+    for (const std::string& s : vec) {
+      T value;
+      libc_parse(s, &value);
+      throwaway += value > 1;
+    }
+    t2 = steady_clock::now();
+    mv2.update(elapsed(t1, t2, samples));
+  }
+
+  if (digits == 0) {
+    printf("shortest");
+  } else {
+    printf("%8d", digits);
+  }
+  printf(" %8.3f %8.3f %8.3f %8.3f %10d\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev(), mismatches);
+  return throwaway;
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  bool run32 = true;
+  bool run64 = true;
+  int samples = 10000;
+  int iterations = 100;
+  for (int i = 1; i < argc; ++i) {
+    const char* const arg = argv[i];
+    if (strcmp(arg, "-32") == 0) {
+      run32 = true;
+      run64 = false;
+    } else if (strcmp(arg, "-64") == 0) {
+      run32 = false;
+      run64 = true;
+    } else if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &samples) != 1 || samples < 1) {
+        printf("Unrecognized option '%s'.\n", arg);
+        exit(EXIT_FAILURE);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &iterations) != 1 || iterations < 1) {
+        printf("Unrecognized option '%s'.\n", arg);
+        exit(EXIT_FAILURE);
+      }
+    } else {
+      printf("Unrecognized option '%s'.\n", arg);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  setbuf(stdout, NULL);
+  int throwaway = 0;
+  if (run32) {
+    printf("  Digits  Average & Stddev s2f  Average & Stddev strtof  Mismatches\n");
+    const int digits[] = { 0, 6, 9, 12, 17, 20, 40, 112 };
+    for (const int d : digits) {
+      throwaway += bench<float>(d, samples, iterations);
+    }
+  }
+  if (run64) {
+    printf("  Digits  Average & Stddev s2d  Average & Stddev strtod  Mismatches\n");
+    // The halfway point between two doubles has up to 767 significant digits.
+    const int digits[] = { 0, 9, 15, 17, 19, 20, 25, 40, 767 };
+    for (const int d : digits) {
+      throwaway += bench<double>(d, samples, iterations);
+    }
+  }
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%d\n", throwaway);
+  }
+  return 0;
+}
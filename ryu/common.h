@@ -25,12 +25,68 @@
 #define RYU_32_BIT_PLATFORM
 #endif
 
+// Vector code paths are enabled if the compiler targets the corresponding instruction set, e.g.,
+// with -mssse3, -mavx2, or -march=native; SSE2 is always available on x86-64. Define RYU_NO_SIMD to
+// disable them.
+#if !defined(RYU_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAS_SSE2
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define HAS_SSSE3
+#endif
+#if defined(__AVX512F__)
+#define HAS_AVX512
+#endif
+#if defined(__AVX2__)
+#define HAS_AVX2
+#endif
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#define HAS_BIT_SCAN
+#elif defined(__GNUC__) || defined(__clang__)
+#define HAS_BIT_SCAN
+#endif
+
+#if defined(HAS_BIT_SCAN)
+
+// POW10_TABLE[i] = 10^i.
+static const uint64_t POW10_TABLE[18] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+  10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+  1000000000000000u, 10000000000000000u, 100000000000000000u
+};
+
+// Returns the number of decimal digits in v (1 for v = 0), which must not contain more than 17 digits.
+// This compiles to lzcnt (or bsr), a multiply, and a single table compare, so unlike a
+// compare chain it costs the same for every input length and cannot mispredict.
+static inline uint32_t decimalLengthBitScan(const uint64_t v) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse64(&index, v | 1);
+  const uint32_t bits = (uint32_t) index + 1;
+#else
+  const uint32_t bits = 64 - (uint32_t) __builtin_clzll(v | 1);
+#endif
+  // 1233 / 4096 is slightly larger than log_10(2), so t is either the number of decimal digits
+  // or one less. A 17-digit number has at most 57 bits, so t <= 17 stays within the table.
+  const uint32_t t = (bits * 1233) >> 12;
+  return t + ((v | 1) >= POW10_TABLE[t]);
+}
+
+#endif // HAS_BIT_SCAN
+
 // Returns the number of decimal digits in v, which must not contain more than 9 digits.
 static inline uint32_t decimalLength9(const uint32_t v) {
   // Function precondition: v is not a 10-digit number.
   // (f2s: 9 digits are sufficient for round-tripping.)
   // (d2fixed: We print 9-digit blocks.)
   assert(v < 1000000000);
+#if defined(HAS_BIT_SCAN)
+  return decimalLengthBitScan(v);
+#else
   if (v >= 100000000) { return 9; }
   if (v >= 10000000) { return 8; }
   if (v >= 1000000) { return 7; }
@@ -40,6 +96,7 @@ static inline uint32_t decimalLength9(const uint32_t v) {
   if (v >= 100) { return 3; }
   if (v >= 10) { return 2; }
   return 1;
+#endif
 }
 
 // Returns e == 0 ? 1 : [log_2(5^e)]; requires 0 <= e <= 3528.
@@ -99,6 +156,28 @@ static inline int copy_special_str(char * const result, const bool sign, const b
   return sign + 3;
 }
 
+// Copies count digits to result, or writes count zeros if digits is NULL, where the first digit is
+// followed by position more digits before the decimal separator. Inserts groupChar after each
+// digit that is followed by a positive multiple of groupSize digits before the decimal separator.
+// Returns the number of characters written.
+static inline int copy_grouped_digits(const char* const digits, const uint32_t count, const uint32_t position,
+  const char groupChar, const uint32_t groupSize, char* const result) {
+  int index = 0;
+  // The number of digits until the next group boundary.
+  uint32_t untilGroup = position % groupSize;
+  for (uint32_t i = 0; i < count; ++i) {
+    result[index++] = digits == NULL ? '0' : digits[i];
+    if (untilGroup == 0) {
+      if (i < position) {
+        result[index++] = groupChar;
+      }
+      untilGroup = groupSize;
+    }
+    --untilGroup;
+  }
+  return index;
+}
+
 static inline uint32_t float_to_bits(const float f) {
   uint32_t bits = 0;
   memcpy(&bits, &f, sizeof(float));
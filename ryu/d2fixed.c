@@ -22,6 +22,11 @@
 //     depending on your compiler.
 //
 // -DRYU_AVOID_UINT128 Avoid using uint128_t. Slower, depending on your compiler.
+//
+// -DRYU_OPTIMIZE_SIZE Use smaller lookup tables. Instead of storing every
+//     required power of 10, only store a few anchors and the bits needed to
+//     compute the others exactly. Reduces the table data from about 100 KB to
+//     about 6 KB, at the cost of a slower conversion.
 
 #include "ryu/ryu.h"
 
@@ -38,9 +43,16 @@
 
 #include "ryu/common.h"
 #include "ryu/digit_table.h"
-#include "ryu/d2fixed_full_table.h"
+#include "ryu/d2fixed_index_table.h"
 #include "ryu/d2s_intrinsics.h"
 
+// Include either the small or the full lookup tables depending on the mode.
+#if defined(RYU_OPTIMIZE_SIZE)
+#include "ryu/d2fixed_small_table.h"
+#else
+#include "ryu/d2fixed_full_table.h"
+#endif
+
 #define DOUBLE_MANTISSA_BITS 52
 #define DOUBLE_EXPONENT_BITS 11
 #define DOUBLE_BIAS 1023
@@ -229,46 +241,6 @@ static inline void append_n_digits(const uint32_t olength, uint32_t digits, char
   }
 }
 
-// Convert `digits` to a sequence of decimal digits. Print the first digit, followed by a decimal
-// dot '.' followed by the remaining digits. The caller has to guarantee that:
-//   10^(olength-1) <= digits < 10^olength
-// e.g., by passing `olength` as `decimalLength9(digits)`.
-static inline void append_d_digits(const uint32_t olength, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
-
-  uint32_t i = 0;
-  while (digits >= 10000) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
-#else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + olength + 1 - i - 4, DIGIT_TABLE + c1, 2);
-    i += 4;
-  }
-  if (digits >= 100) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c, 2);
-    i += 2;
-  }
-  if (digits >= 10) {
-    const uint32_t c = digits << 1;
-    result[2] = DIGIT_TABLE[c + 1];
-    result[1] = '.';
-    result[0] = DIGIT_TABLE[c];
-  } else {
-    result[1] = '.';
-    result[0] = (char) ('0' + digits);
-  }
-}
-
 // Convert `digits` to decimal and write the last `count` decimal digits to result.
 // If `digits` contains additional digits, then those are silently ignored.
 static inline void append_c_digits(const uint32_t count, uint32_t digits, char* const result) {
@@ -315,6 +287,29 @@ static inline void append_nine_digits(uint32_t digits, char* const result) {
   result[0] = (char) ('0' + digits);
 }
 
+// Append the exponent in printf's %e format, e.g., "e+05" or "e-123", and return its length.
+static inline int append_exponent(int32_t exp, char* const result) {
+  int index = 0;
+  result[index++] = 'e';
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else {
+    result[index++] = '+';
+  }
+
+  if (exp >= 100) {
+    const int32_t c = exp % 10;
+    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
+    result[index + 2] = (char) ('0' + c);
+    index += 3;
+  } else {
+    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+    index += 2;
+  }
+  return index;
+}
+
 static inline uint32_t indexForExponent(const uint32_t e) {
   return (e + 15) / 16;
 }
@@ -328,6 +323,28 @@ static inline uint32_t lengthForIndex(const uint32_t idx) {
   return (log10Pow2(16 * (int32_t) idx) + 1 + 16 + 8) / 9;
 }
 
+// Returns mulShift_mod1e9(m, POW10_SPLIT[POW10_OFFSET[idx] + i], j).
+static inline uint32_t mulShift_pow10Split(const uint64_t m, const uint32_t idx, const uint32_t i, const int32_t j) {
+#if defined(RYU_OPTIMIZE_SIZE)
+  uint64_t mul[3];
+  computePow10Split(idx, i, mul);
+  return mulShift_mod1e9(m, mul, j);
+#else
+  return mulShift_mod1e9(m, POW10_SPLIT[POW10_OFFSET[idx] + i], j);
+#endif
+}
+
+// Returns mulShift_mod1e9(m, POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]], j).
+static inline uint32_t mulShift_pow10Split2(const uint64_t m, const uint32_t idx, const uint32_t i, const int32_t j) {
+#if defined(RYU_OPTIMIZE_SIZE)
+  uint64_t mul[3];
+  computePow10Split2(idx, i, mul);
+  return mulShift_mod1e9(m, mul, j);
+#else
+  return mulShift_mod1e9(m, POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]], j);
+#endif
+}
+
 static inline int copy_special_str_printf(char* const result, const bool sign, const uint64_t mantissa) {
 #if defined(_MSC_VER)
   // TODO: Check that -nan is expected output on Windows.
@@ -355,7 +372,257 @@ static inline int copy_special_str_printf(char* const result, const bool sign, c
   return sign + 8;
 }
 
-int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
+// Decides how to round the last printed digit of a number with the given sign: returns 0 to keep
+// it, 1 to round up unconditionally, and 2 to round up if odd. cmp is -1, 0, or 1 if the dropped
+// digits are less than, equal to, or greater than half a unit of the last printed digit, and exact
+// is true if they are all zero. Rounding up always increases the magnitude.
+static inline int roundingDecision(const enum ryu_rounding mode, const bool sign, const int cmp, const bool exact) {
+  switch (mode) {
+  case RYU_ROUND_HALF_UP:
+    return cmp >= 0;
+  case RYU_ROUND_TRUNCATE:
+    return 0;
+  case RYU_ROUND_FLOOR:
+    return sign && !exact;
+  case RYU_ROUND_CEIL:
+    return !sign && !exact;
+  default:
+    return cmp < 0 ? 0 : cmp > 0 ? 1 : 2;
+  }
+}
+
+// Only the directed rounding modes need to know whether the dropped digits are all zero if the
+// first one is 0.
+static inline bool needsExactness(const enum ryu_rounding mode) {
+  return mode == RYU_ROUND_FLOOR || mode == RYU_ROUND_CEIL;
+}
+
+// The notations of the d2exp family: d2exp uses any exponent, and d2eng only multiples of 3, which
+// it can also print as an SI prefix.
+enum exp_notation {
+  NOTATION_SCIENTIFIC,
+  NOTATION_ENGINEERING,
+  NOTATION_SI
+};
+
+// The SI prefixes for 10^-30 to 10^30 in steps of 3, in UTF-8.
+static const char* const SI_PREFIXES[21] = {
+  "q", "r", "y", "z", "a", "f", "p", "n", "\xC2\xB5", "m", "", "k", "M", "G", "T", "P", "E", "Z", "Y", "R", "Q"
+};
+
+// Finishes the output of the d2exp family. The count digits of the significand are at result[1],
+// and the first of them has the value 10^exp. Moves the leading digits to result[0] and inserts the
+// decimal point after them, padding with zeros if there are fewer digits than that, then appends the
+// exponent. Returns the length of the output at result.
+static inline int append_exp_notation(const uint32_t count, const int32_t exp, const enum exp_notation notation,
+  char* const result) {
+  if (notation == NOTATION_SCIENTIFIC) {
+    result[0] = result[1];
+    if (count == 1) {
+      return 1 + append_exponent(exp, result + 1);
+    }
+    result[1] = '.';
+    return (int) count + 1 + append_exponent(exp, result + count + 1);
+  }
+  // Engineering notation has one to three digits before the decimal point.
+  const uint32_t shift = (uint32_t) (((exp % 3) + 3) % 3);
+  const uint32_t leading = 1 + shift;
+  int index;
+  if (count > leading) {
+    for (uint32_t i = 0; i < leading; ++i) {
+      result[i] = result[i + 1];
+    }
+    result[leading] = '.';
+    index = (int) count + 1;
+  } else {
+    for (uint32_t i = 0; i < count; ++i) {
+      result[i] = result[i + 1];
+    }
+    memset(result + count, '0', leading - count);
+    index = (int) leading;
+  }
+  const int32_t e = exp - (int32_t) shift;
+  if (notation == NOTATION_SI && e >= -30 && e <= 30) {
+    const char* const prefix = SI_PREFIXES[(e + 30) / 3];
+    const size_t length = strlen(prefix);
+    memcpy(result + index, prefix, length);
+    return index + (int) length;
+  }
+  return index + append_exponent(e, result + index);
+}
+
+#if defined(HAS_UINT128)
+
+// The powers of 10 that fit into 64 bits.
+static const uint64_t POW10_64[20] = {
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+  1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+  100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+  1000000000000000000ull, 10000000000000000000ull
+};
+
+// Convert `value` to a sequence of decimal digits without leading zeros. Append the digits to the
+// result and return their count.
+static inline int append_u64_digits(const uint64_t value, char* const result) {
+  if (value < 1000000000) {
+    const uint32_t olength = decimalLength9((uint32_t) value);
+    append_n_digits(olength, (uint32_t) value, result);
+    return (int) olength;
+  }
+  const uint64_t q = div1e9(value);
+  const int length = append_u64_digits(q, result);
+  append_nine_digits((uint32_t) (value - 1000000000 * q), result + length);
+  return length + 9;
+}
+
+// Returns floor(m2 * 2^e2 * 10^k), sets *cmp to -1, 0, or 1 if the remaining fraction is less
+// than, equal to, or greater than 1/2, and *exact to whether it is 0. The caller has to guarantee
+// that |k| <= 19, that m2 * 2^max(e2, 0) < 2^64, and, if k is negative, that the result is at
+// least 1.
+static inline uint128_t mulShiftPow10(const uint64_t m2, const int32_t e2, const int32_t k, int* const cmp,
+  bool* const exact) {
+  if (k < 0) {
+    // Both the value and the divisor 10^-k * 2^-e2 fit into 64 bits.
+    const uint64_t n = e2 >= 0 ? m2 << e2 : m2;
+    const uint64_t d = e2 >= 0 ? POW10_64[-k] : POW10_64[-k] << -e2;
+    const uint64_t q = n / d;
+    const uint64_t r = n - q * d;
+    *cmp = r < d - r ? -1 : r > d - r;
+    *exact = r == 0;
+    return q;
+  }
+  if (e2 >= 0) {
+    *cmp = -1;
+    *exact = true;
+    return (uint128_t) (m2 << e2) * POW10_64[k];
+  }
+  // m2 * 10^k < 2^117, so the result is 0 and below 1/2 if we shift by 128 or more.
+  const uint128_t n = (uint128_t) m2 * POW10_64[k];
+  const uint32_t shift = (uint32_t) -e2;
+  if (shift >= 128) {
+    *cmp = -1;
+    *exact = n == 0;
+    return 0;
+  }
+  const uint128_t r = n & ((((uint128_t) 1) << shift) - 1);
+  const uint128_t half = ((uint128_t) 1) << (shift - 1);
+  *cmp = r < half ? -1 : r > half;
+  *exact = r == 0;
+  return n >> shift;
+}
+
+// d2fixed_buffered_n for precision <= 17 and m2 * 2^e2 < 2^64. We compute the integer part and
+// round(fraction * 10^precision) directly, rather than going through the 9-digit blocks.
+static inline int d2fixed_small(const bool sign, const uint64_t m2, const int32_t e2, const uint32_t precision,
+  const enum ryu_rounding mode, const ryu_separators* const separators, char* const result) {
+  uint64_t integer;
+  uint64_t fraction = 0;
+  if (e2 >= 0) {
+    integer = m2 << e2;
+  } else {
+    const uint32_t shift = (uint32_t) -e2;
+    integer = shift < 64 ? m2 >> shift : 0;
+    const uint64_t fractionBits = shift < 64 ? m2 & ((1ull << shift) - 1) : m2;
+    int cmp;
+    bool exact;
+    fraction = (uint64_t) mulShiftPow10(fractionBits, e2, (int32_t) precision, &cmp, &exact);
+    // If precision is 0, then the last printed digit is the last digit of the integer part.
+    const uint64_t last = precision == 0 ? integer : fraction;
+    const int roundUp = roundingDecision(mode, sign, cmp, exact);
+    if (roundUp == 1 || (roundUp == 2 && (last & 1) != 0)) {
+      ++fraction;
+      if (fraction == POW10_64[precision]) {
+        ++integer;
+        fraction = 0;
+      }
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("integer=%" PRIu64 " fraction=%" PRIu64 "\n", integer, fraction);
+#endif
+
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+  if (separators->group_char != '\0' && separators->group_size != 0) {
+    char digits[20];
+    const int length = append_u64_digits(integer, digits);
+    index += copy_grouped_digits(digits, (uint32_t) length, (uint32_t) length - 1,
+      separators->group_char, separators->group_size, result + index);
+  } else {
+    index += append_u64_digits(integer, result + index);
+  }
+  if (precision > 0) {
+    result[index++] = separators->decimal_char;
+    if (precision > 9) {
+      const uint64_t q = div1e9(fraction);
+      append_c_digits(precision - 9, (uint32_t) q, result + index);
+      append_nine_digits((uint32_t) (fraction - 1000000000 * q), result + index + precision - 9);
+    } else {
+      append_c_digits(precision, (uint32_t) fraction, result + index);
+    }
+    index += precision;
+  }
+  return index;
+}
+
+// d2exp_buffered_n for precision <= 17 and 10^(precision - 19) <= m2 * 2^e2 < 2^64; returns -1
+// for other values. We compute round(m2 * 2^e2 * 10^(precision - exp)) directly, rather than going
+// through the 9-digit blocks. The result has precision + 1 digits, and the decimal exponent exp is
+// written to *exp.
+static inline int64_t d2exp_small(const bool sign, const uint64_t m2, const int32_t e2, const uint32_t precision,
+  const enum ryu_rounding mode, int32_t* const exp) {
+  // m2 * 2^e2 is in [2^e, 2^(e+1)), so the decimal exponent is log10(2^e) rounded down, or one more.
+  const int32_t e = e2 + DOUBLE_MANTISSA_BITS;
+  int32_t e10 = e >= 0 ? (int32_t) log10Pow2(e) : -(int32_t) log10Pow2(-e) - 1;
+  int32_t k = (int32_t) precision - e10;
+  if (k > 19) {
+    return -1;
+  }
+  int cmp;
+  bool exact;
+  uint64_t digits = (uint64_t) mulShiftPow10(m2, e2, k, &cmp, &exact);
+  if (digits >= POW10_64[precision + 1]) {
+    ++e10;
+    --k;
+    digits = (uint64_t) mulShiftPow10(m2, e2, k, &cmp, &exact);
+  }
+  const int roundUp = roundingDecision(mode, sign, cmp, exact);
+  if (roundUp == 1 || (roundUp == 2 && (digits & 1) != 0)) {
+    ++digits;
+    if (digits == POW10_64[precision + 1]) {
+      ++e10;
+      digits = POW10_64[precision];
+    }
+  }
+  *exp = e10;
+  return (int64_t) digits;
+}
+
+// Prints the result of d2exp_small.
+static inline int d2exp_small_to_chars(const bool sign, const uint64_t digits, const int32_t exp,
+  const uint32_t precision, const enum exp_notation notation, char* const result) {
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+  // Print all digits one position to the right, then move the leading digits before the dot.
+  append_u64_digits(digits, result + index + 1);
+  return index + append_exp_notation(precision + 1, exp, notation, result + index);
+}
+
+#endif // defined(HAS_UINT128)
+
+// The separators of d2fixed_buffered_n: no grouping and a '.' before the fraction.
+static const ryu_separators DEFAULT_SEPARATORS = { '\0', 0, '.' };
+
+static inline int d2fixed_separated_buffered_n(const double d, const uint32_t precision, const enum ryu_rounding mode,
+  const ryu_separators* const separators, char* const result) {
+  // A group size of 0 disables grouping, like a '\0' group_char.
+  const char groupChar = separators->group_size == 0 ? '\0' : separators->group_char;
+  const uint32_t groupSize = separators->group_size;
+  const char decimalChar = separators->decimal_char;
   const uint64_t bits = double_to_bits(d);
 #ifdef RYU_DEBUG
   printf("IN=");
@@ -381,7 +648,7 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
     }
     result[index++] = '0';
     if (precision > 0) {
-      result[index++] = '.';
+      result[index++] = decimalChar;
       memset(result + index, '0', precision);
       index += precision;
     }
@@ -402,8 +669,16 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
   printf("-> %" PRIu64 " * 2^%d\n", m2, e2);
 #endif
 
+#if defined(HAS_UINT128)
+  if (precision <= 17 && e2 < 64 - DOUBLE_MANTISSA_BITS) {
+    return d2fixed_small(ieeeSign, m2, e2, precision, mode, separators, result);
+  }
+#endif
+
   int index = 0;
   bool nonzero = false;
+  // The number of digits before the decimal separator, if nonzero.
+  uint32_t intLength = 0;
   if (ieeeSign) {
     result[index++] = '-';
   }
@@ -419,14 +694,27 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
       const uint32_t j = p10bits - e2;
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      const uint32_t digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT[POW10_OFFSET[idx] + i], (int32_t) (j + 8));
+      const uint32_t digits = mulShift_pow10Split(m2 << 8, idx, (uint32_t) i, (int32_t) (j + 8));
       if (nonzero) {
-        append_nine_digits(digits, result + index);
-        index += 9;
+        if (groupChar != '\0') {
+          char blockChars[9];
+          append_nine_digits(digits, blockChars);
+          index += copy_grouped_digits(blockChars, 9, 9 * (uint32_t) i + 8, groupChar, groupSize, result + index);
+        } else {
+          append_nine_digits(digits, result + index);
+          index += 9;
+        }
       } else if (digits != 0) {
         const uint32_t olength = decimalLength9(digits);
-        append_n_digits(olength, digits, result + index);
-        index += olength;
+        intLength = olength + 9 * (uint32_t) i;
+        if (groupChar != '\0') {
+          char blockChars[9];
+          append_n_digits(olength, digits, blockChars);
+          index += copy_grouped_digits(blockChars, olength, intLength - 1, groupChar, groupSize, result + index);
+        } else {
+          append_n_digits(olength, digits, result + index);
+          index += olength;
+        }
         nonzero = true;
       }
     }
@@ -435,7 +723,7 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
     result[index++] = '0';
   }
   if (precision > 0) {
-    result[index++] = '.';
+    result[index++] = decimalChar;
   }
 #ifdef RYU_DEBUG
   printf("e2=%d\n", e2);
@@ -450,6 +738,8 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
     int roundUp = 0;
     uint32_t i = 0;
     if (blocks <= MIN_BLOCK_2[idx]) {
+      // All printed digits and the next one are 0, but the value is not.
+      roundUp = roundingDecision(mode, ieeeSign, -1, false);
       i = blocks;
       memset(result + index, '0', precision);
       index += precision;
@@ -471,7 +761,7 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
       }
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      uint32_t digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT_2[p], j + 8);
+      uint32_t digits = mulShift_pow10Split2(m2 << 8, (uint32_t) idx, i, j + 8);
 #ifdef RYU_DEBUG
       printf("digits=%u\n", digits);
 #endif
@@ -488,19 +778,24 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
 #ifdef RYU_DEBUG
         printf("lastDigit=%u\n", lastDigit);
 #endif
-        if (lastDigit != 5) {
-          roundUp = lastDigit > 5;
-        } else {
+        int cmp = lastDigit < 5 ? -1 : lastDigit > 5;
+        bool exact = false;
+        if (lastDigit == 5 || (lastDigit == 0 && needsExactness(mode))) {
           // Is m * 10^(additionalDigits + 1) / 2^(-e2) integer?
           const int32_t requiredTwos = -e2 - (int32_t) precision - 1;
           const bool trailingZeros = requiredTwos <= 0
             || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
-          roundUp = trailingZeros ? 2 : 1;
+          if (lastDigit == 5) {
+            cmp = !trailingZeros;
+          } else {
+            exact = trailingZeros;
+          }
 #ifdef RYU_DEBUG
           printf("requiredTwos=%d\n", requiredTwos);
           printf("trailingZeros=%s\n", trailingZeros ? "true" : "false");
 #endif
         }
+        roundUp = roundingDecision(mode, ieeeSign, cmp, exact);
         if (maximum > 0) {
           append_c_digits(maximum, digits, result + index);
           index += maximum;
@@ -518,17 +813,32 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
         --roundIndex;
         char c;
         if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+          if (groupChar != '\0' && intLength > 0) {
+            // All integer digits were 9, so the integer part becomes 10^intLength, which has one
+            // more digit and possibly one more group separator; rewrite it from the start.
+            index = roundIndex + 1;
+            index += copy_grouped_digits("1", 1, intLength, groupChar, groupSize, result + index);
+            index += copy_grouped_digits(NULL, intLength, intLength - 1, groupChar, groupSize, result + index);
+            if (precision > 0) {
+              result[index++] = decimalChar;
+              memset(result + index, '0', precision);
+              index += precision;
+            }
+            break;
+          }
           result[roundIndex + 1] = '1';
           if (dotIndex > 0) {
             result[dotIndex] = '0';
-            result[dotIndex + 1] = '.';
+            result[dotIndex + 1] = decimalChar;
           }
           result[index++] = '0';
           break;
         }
-        if (c == '.') {
+        if (c == decimalChar) {
           dotIndex = roundIndex;
           continue;
+        } else if (c == groupChar) {
+          continue;
         } else if (c == '9') {
           result[roundIndex] = '0';
           roundUp = 1;
@@ -549,6 +859,18 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
   return index;
 }
 
+int d2fixed_rounded_buffered_n(double d, uint32_t precision, enum ryu_rounding mode, char* result) {
+  return d2fixed_separated_buffered_n(d, precision, mode, &DEFAULT_SEPARATORS, result);
+}
+
+int d2fixed_grouped_buffered_n(double d, uint32_t precision, const ryu_separators* separators, char* result) {
+  return d2fixed_separated_buffered_n(d, precision, RYU_ROUND_HALF_EVEN, separators, result);
+}
+
+int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
+  return d2fixed_rounded_buffered_n(d, precision, RYU_ROUND_HALF_EVEN, result);
+}
+
 void d2fixed_buffered(double d, uint32_t precision, char* result) {
   const int len = d2fixed_buffered_n(d, precision, result);
   result[len] = '\0';
@@ -561,9 +883,43 @@ char* d2fixed(double d, uint32_t precision) {
   return buffer;
 }
 
+int d2fixed_batch(const double* values, int count, uint32_t precision, char* result, int* offsets) {
+  // All values share the precision, so we decide once whether the fast path applies, and keep it
+  // inlined into this loop with the rounding mode fixed. This avoids the per-value call overhead,
+  // and lets the compiler hoist the precision-dependent powers of 10 and branches out of the loop.
+  // Everything else goes through d2fixed_buffered_n.
+  int index = 0;
+  int i = 0;
+#if defined(HAS_UINT128)
+  if (precision <= 17) {
+    for (; i < count; ++i) {
+      offsets[i] = index;
+      const uint64_t bits = double_to_bits(values[i]);
+      const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+      // Normal numbers below 2^64, i.e., e2 < 64 - DOUBLE_MANTISSA_BITS.
+      if (ieeeExponent != 0 && ieeeExponent < DOUBLE_BIAS + 64) {
+        const bool ieeeSign = (bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) != 0;
+        const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | (bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1));
+        const int32_t e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+        index += d2fixed_small(ieeeSign, m2, e2, precision, RYU_ROUND_HALF_EVEN, &DEFAULT_SEPARATORS, result + index);
+      } else {
+        index += d2fixed_buffered_n(values[i], precision, result + index);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    offsets[i] = index;
+    index += d2fixed_buffered_n(values[i], precision, result + index);
+  }
+  offsets[count] = index;
+  return index;
+}
 
-
-int d2exp_buffered_n(double d, uint32_t precision, char* result) {
+// d2exp_rounded_buffered_n for any of the notations; see append_exp_notation. Unless d is infinite
+// or NaN, stores the decimal exponent of the first printed digit in *decimalExp.
+static inline int d2exp_notation_buffered_n(const double d, uint32_t precision, const enum ryu_rounding mode,
+  const enum exp_notation notation, char* const result, int32_t* const decimalExp) {
   const uint64_t bits = double_to_bits(d);
 #ifdef RYU_DEBUG
   printf("IN=");
@@ -587,15 +943,9 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
     if (ieeeSign) {
       result[index++] = '-';
     }
-    result[index++] = '0';
-    if (precision > 0) {
-      result[index++] = '.';
-      memset(result + index, '0', precision);
-      index += precision;
-    }
-    memcpy(result + index, "e+00", 4);
-    index += 4;
-    return index;
+    memset(result + index + 1, '0', precision + 1);
+    *decimalExp = 0;
+    return index + append_exp_notation(precision + 1, 0, notation, result + index);
   }
 
   int32_t e2;
@@ -612,12 +962,25 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
   printf("-> %" PRIu64 " * 2^%d\n", m2, e2);
 #endif
 
-  const bool printDecimalPoint = precision > 0;
+#if defined(HAS_UINT128)
+  if (precision <= 17 && e2 < 64 - DOUBLE_MANTISSA_BITS) {
+    int32_t exp;
+    const int64_t digits = d2exp_small(ieeeSign, m2, e2, precision, mode, &exp);
+    if (digits >= 0) {
+      *decimalExp = exp;
+      return d2exp_small_to_chars(ieeeSign, (uint64_t) digits, exp, precision, notation, result);
+    }
+  }
+#endif
+
   ++precision;
   int index = 0;
   if (ieeeSign) {
     result[index++] = '-';
   }
+  // We print all digits one position to the right, and move the leading digits before the decimal
+  // point at the end.
+  const int start = index++;
   uint32_t digits = 0;
   uint32_t printedDigits = 0;
   uint32_t availableDigits = 0;
@@ -634,7 +997,7 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
       const uint32_t j = p10bits - e2;
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT[POW10_OFFSET[idx] + i], (int32_t) (j + 8));
+      digits = mulShift_pow10Split(m2 << 8, idx, (uint32_t) i, (int32_t) (j + 8));
       if (printedDigits != 0) {
         if (printedDigits + 9 > precision) {
           availableDigits = 9;
@@ -649,12 +1012,8 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
         if (availableDigits > precision) {
           break;
         }
-        if (printDecimalPoint) {
-          append_d_digits(availableDigits, digits, result + index);
-          index += availableDigits + 1; // +1 for decimal point
-        } else {
-          result[index++] = (char) ('0' + digits);
-        }
+        append_n_digits(availableDigits, digits, result + index);
+        index += availableDigits;
         printedDigits = availableDigits;
         availableDigits = 0;
       }
@@ -671,9 +1030,9 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
       const uint32_t p = POW10_OFFSET_2[idx] + (uint32_t) i - MIN_BLOCK_2[idx];
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      digits = (p >= POW10_OFFSET_2[idx + 1]) ? 0 : mulShift_mod1e9(m2 << 8, POW10_SPLIT_2[p], j + 8);
+      digits = (p >= POW10_OFFSET_2[idx + 1]) ? 0 : mulShift_pow10Split2(m2 << 8, (uint32_t) idx, (uint32_t) i, j + 8);
 #ifdef RYU_DEBUG
-      printf("exact=%" PRIu64 " * (%" PRIu64 " + %" PRIu64 " << 64) >> %d\n", m2, POW10_SPLIT_2[p][0], POW10_SPLIT_2[p][1], j);
+      printf("exact=%" PRIu64 " * POW10_SPLIT_2[%u] >> %d\n", m2, p, j);
       printf("digits=%u\n", digits);
 #endif
       if (printedDigits != 0) {
@@ -690,12 +1049,8 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
         if (availableDigits > precision) {
           break;
         }
-        if (printDecimalPoint) {
-          append_d_digits(availableDigits, digits, result + index);
-          index += availableDigits + 1; // +1 for decimal point
-        } else {
-          result[index++] = (char) ('0' + digits);
-        }
+        append_n_digits(availableDigits, digits, result + index);
+        index += availableDigits;
         printedDigits = availableDigits;
         availableDigits = 0;
       }
@@ -721,11 +1076,9 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
 #ifdef RYU_DEBUG
   printf("lastDigit=%u\n", lastDigit);
 #endif
-  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
-  int roundUp = 0;
-  if (lastDigit != 5) {
-    roundUp = lastDigit > 5;
-  } else {
+  int cmp = lastDigit < 5 ? -1 : lastDigit > 5;
+  bool exact = false;
+  if (lastDigit == 5 || (lastDigit == 0 && needsExactness(mode))) {
     // Is m * 2^e2 * 10^(precision + 1 - exp) integer?
     // precision was already increased by 1, so we don't need to write + 1 here.
     const int32_t rexp = (int32_t) precision - exp;
@@ -736,12 +1089,18 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
       const int32_t requiredFives = -rexp;
       trailingZeros = trailingZeros && multipleOfPowerOf5(m2, (uint32_t) requiredFives);
     }
-    roundUp = trailingZeros ? 2 : 1;
+    if (lastDigit == 5) {
+      cmp = !trailingZeros;
+    } else {
+      exact = trailingZeros;
+    }
 #ifdef RYU_DEBUG
     printf("requiredTwos=%d\n", requiredTwos);
     printf("trailingZeros=%s\n", trailingZeros ? "true" : "false");
 #endif
   }
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = roundingDecision(mode, ieeeSign, cmp, exact);
   if (printedDigits != 0) {
     if (digits == 0) {
       memset(result + index, '0', maximum);
@@ -750,12 +1109,8 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
     }
     index += maximum;
   } else {
-    if (printDecimalPoint) {
-      append_d_digits(maximum, digits, result + index);
-      index += maximum + 1; // +1 for decimal point
-    } else {
-      result[index++] = (char) ('0' + digits);
-    }
+    append_n_digits(maximum, digits, result + index);
+    index += maximum;
   }
 #ifdef RYU_DEBUG
   printf("roundUp=%d\n", roundUp);
@@ -764,15 +1119,14 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
     int roundIndex = index;
     while (true) {
       --roundIndex;
-      char c;
-      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
-        result[roundIndex + 1] = '1';
+      if (roundIndex == start) {
+        // All digits were 9 and are now 0.
+        result[start + 1] = '1';
         ++exp;
         break;
       }
-      if (c == '.') {
-        continue;
-      } else if (c == '9') {
+      const char c = result[roundIndex];
+      if (c == '9') {
         result[roundIndex] = '0';
         roundUp = 1;
         continue;
@@ -785,25 +1139,17 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
       }
     }
   }
-  result[index++] = 'e';
-  if (exp < 0) {
-    result[index++] = '-';
-    exp = -exp;
-  } else {
-    result[index++] = '+';
-  }
+  *decimalExp = exp;
+  return start + append_exp_notation(precision, exp, notation, result + start);
+}
 
-  if (exp >= 100) {
-    const int32_t c = exp % 10;
-    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
-    result[index + 2] = (char) ('0' + c);
-    index += 3;
-  } else {
-    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
-    index += 2;
-  }
+int d2exp_rounded_buffered_n(double d, uint32_t precision, enum ryu_rounding mode, char* result) {
+  int32_t exp;
+  return d2exp_notation_buffered_n(d, precision, mode, NOTATION_SCIENTIFIC, result, &exp);
+}
 
-  return index;
+int d2exp_buffered_n(double d, uint32_t precision, char* result) {
+  return d2exp_rounded_buffered_n(d, precision, RYU_ROUND_HALF_EVEN, result);
 }
 
 void d2exp_buffered(double d, uint32_t precision, char* result) {
@@ -817,3 +1163,462 @@ char* d2exp(double d, uint32_t precision) {
   buffer[index] = '\0';
   return buffer;
 }
+
+int d2exp_batch(const double* values, int count, uint32_t precision, char* result, int* offsets) {
+  // Same as d2fixed_batch.
+  int index = 0;
+  int i = 0;
+#if defined(HAS_UINT128)
+  if (precision <= 17) {
+    for (; i < count; ++i) {
+      offsets[i] = index;
+      const uint64_t bits = double_to_bits(values[i]);
+      const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+      if (ieeeExponent != 0 && ieeeExponent < DOUBLE_BIAS + 64) {
+        const bool ieeeSign = (bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) != 0;
+        const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | (bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1));
+        const int32_t e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+        int32_t exp;
+        const int64_t digits = d2exp_small(ieeeSign, m2, e2, precision, RYU_ROUND_HALF_EVEN, &exp);
+        if (digits >= 0) {
+          index += d2exp_small_to_chars(ieeeSign, (uint64_t) digits, exp, precision, NOTATION_SCIENTIFIC, result + index);
+          continue;
+        }
+      }
+      index += d2exp_buffered_n(values[i], precision, result + index);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    offsets[i] = index;
+    index += d2exp_buffered_n(values[i], precision, result + index);
+  }
+  offsets[count] = index;
+  return index;
+}
+
+int d2eng_buffered_n(double d, uint32_t precision, uint32_t flags, char* result) {
+  // As in d2general, precision is the number of significant digits, and 0 means 1.
+  const uint32_t significant = precision == 0 ? 1 : precision;
+  const enum exp_notation notation = (flags & RYU_SI_PREFIX) != 0 ? NOTATION_SI : NOTATION_ENGINEERING;
+  int32_t exp;
+  return d2exp_notation_buffered_n(d, significant - 1, RYU_ROUND_HALF_EVEN, notation, result, &exp);
+}
+
+void d2eng_buffered(double d, uint32_t precision, uint32_t flags, char* result) {
+  const int len = d2eng_buffered_n(d, precision, flags, result);
+  result[len] = '\0';
+}
+
+char* d2eng(double d, uint32_t precision, uint32_t flags) {
+  char* const buffer = (char*)malloc(precision + 11);
+  const int index = d2eng_buffered_n(d, precision, flags, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
+
+int d2general_buffered_n(double d, uint32_t precision, uint32_t flags, char* result) {
+  // As in printf, precision is the number of significant digits, and 0 means 1.
+  const int32_t significant = precision == 0 ? 1 : (int32_t) precision;
+  // d2exp already computes the digits and the exponent after rounding to this many significant
+  // digits; we only need to move the decimal point if %g uses fixed notation for this exponent.
+  int32_t exp;
+  const int length = d2exp_notation_buffered_n(d, (uint32_t) significant - 1, RYU_ROUND_HALF_EVEN,
+    NOTATION_SCIENTIFIC, result, &exp);
+  const uint64_t bits = double_to_bits(d);
+  if (((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1)) == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    // Infinity or NaN.
+    return length;
+  }
+
+  // The exponent has two or three digits after 'e' and its sign.
+  const int eIndex = length - (exp <= -100 || exp >= 100 ? 5 : 4);
+  const bool alternate = (flags & RYU_ALTERNATE_FORM) != 0;
+#ifdef RYU_DEBUG
+  printf("exp=%d\n", exp);
+#endif
+
+  if (exp < -4 || exp >= significant) {
+    // Exponential notation. Remove trailing zeros, and the decimal point if no digits follow it.
+    if (significant == 1) {
+      if (!alternate) {
+        return length;
+      }
+      // The alternate form always has a decimal point.
+      memmove(result + eIndex + 1, result + eIndex, (size_t) (length - eIndex));
+      result[eIndex] = '.';
+      return length + 1;
+    }
+    if (alternate) {
+      return length;
+    }
+    int end = eIndex;
+    while (result[end - 1] == '0') {
+      --end;
+    }
+    if (result[end - 1] == '.') {
+      --end;
+    }
+    memmove(result + end, result + eIndex, (size_t) (length - eIndex));
+    return end + length - eIndex;
+  }
+
+  // Fixed notation with significant - 1 - exp digits after the decimal point. The digits are the
+  // same as in exponential notation, at result[start] and, if significant > 1, after the decimal
+  // point at result[start + 2].
+  const int start = result[0] == '-';
+  int index;
+  bool hasPoint;
+  if (exp >= 0) {
+    // Move the decimal point exp digits to the right.
+    memmove(result + start + 1, result + start + 2, (size_t) exp);
+    hasPoint = exp < significant - 1;
+    if (hasPoint) {
+      result[start + 1 + exp] = '.';
+      index = start + 1 + significant;
+    } else {
+      index = start + significant;
+    }
+  } else {
+    // Print 0.000ddd with -exp - 1 zeros after the decimal point.
+    if (significant > 1) {
+      memmove(result + start + 2 - exp, result + start + 2, (size_t) significant - 1);
+    }
+    result[start + 1 - exp] = result[start];
+    result[start] = '0';
+    result[start + 1] = '.';
+    memset(result + start + 2, '0', (size_t) (-exp - 1));
+    hasPoint = true;
+    index = start + 1 - exp + significant;
+  }
+  if (alternate) {
+    if (!hasPoint) {
+      result[index++] = '.';
+    }
+  } else if (hasPoint) {
+    while (result[index - 1] == '0') {
+      --index;
+    }
+    if (result[index - 1] == '.') {
+      --index;
+    }
+  }
+  return index;
+}
+
+void d2general_buffered(double d, uint32_t precision, uint32_t flags, char* result) {
+  const int len = d2general_buffered_n(d, precision, flags, result);
+  result[len] = '\0';
+}
+
+char* d2general(double d, uint32_t precision, uint32_t flags) {
+  char* const buffer = (char*)malloc((precision == 0 ? 1 : precision) + 9);
+  const int index = d2general_buffered_n(d, precision, flags, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
+
+// Returns the 9-digit block floor(m2 * 2^e2 / 10^(9 * k)) mod 10^9, using the same table entries
+// as d2fixed_buffered_n: k >= 0 selects the integer part, and k < 0 fractional block -k - 1.
+static inline uint32_t digitBlock(const uint64_t m2, const int32_t e2, const int32_t k) {
+  if (k >= 0) {
+    if (e2 < -52) {
+      return 0;
+    }
+    const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
+    if ((uint32_t) k >= lengthForIndex(idx)) {
+      return 0;
+    }
+    const uint32_t j = pow10BitsForIndex(idx) - e2;
+    return mulShift_pow10Split(m2 << 8, idx, (uint32_t) k, (int32_t) (j + 8));
+  }
+  if (e2 >= 0) {
+    return 0;
+  }
+  const uint32_t i = (uint32_t) (-k - 1);
+  const int32_t idx = -e2 / 16;
+  if (i < MIN_BLOCK_2[idx]) {
+    return 0;
+  }
+  const uint32_t p = POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx];
+  if (p >= POW10_OFFSET_2[idx + 1]) {
+    return 0;
+  }
+  const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
+  return mulShift_pow10Split2(m2 << 8, (uint32_t) idx, i, j + 8);
+}
+
+// Returns the index of the block that contains the digit at the given position, i.e.,
+// floor(position / 9).
+static inline int32_t blockForPosition(const int32_t position) {
+  return position >= 0 ? position / 9 : -((8 - position) / 9);
+}
+
+// The most recently computed block during stream initialization, which usually needs the same block
+// several times.
+typedef struct block_cache {
+  int32_t k;
+  uint32_t digits;
+} block_cache;
+
+static inline uint32_t cachedDigitBlock(block_cache* const cache, const uint64_t m2, const int32_t e2, const int32_t k) {
+  if (cache->k != k) {
+    cache->k = k;
+    cache->digits = digitBlock(m2, e2, k);
+  }
+  return cache->digits;
+}
+
+// Returns the digits at positions position, position + 1, ... of m2 * 2^e2, up to the end of the
+// block, as an integer with the digit at position as its last digit.
+static inline uint32_t digitsFrom(block_cache* const cache, const uint64_t m2, const int32_t e2, const int32_t position) {
+  const int32_t k = blockForPosition(position);
+  uint32_t digits = cachedDigitBlock(cache, m2, e2, k);
+  for (int32_t o = position - 9 * k; o > 0; --o) {
+    digits /= 10;
+  }
+  return digits;
+}
+
+// Stores the characters of block k with the given digits in the stream, applying the rounding.
+static inline void renderBlock(ryu_stream* const stream, const int32_t k, const uint32_t digits) {
+  append_nine_digits(digits, stream->blockChars);
+  const int32_t carry = stream->carry;
+  if (carry != INT32_MIN && carry >= 9 * k) {
+    for (int32_t o = 0; o < 9; ++o) {
+      if (9 * k + o < carry) {
+        stream->blockChars[8 - o] = '0';
+      } else if (9 * k + o == carry) {
+        ++stream->blockChars[8 - o];
+      }
+    }
+  }
+  stream->block = k;
+}
+
+enum ryu_stream_stage {
+  STREAM_PREFIX,
+  STREAM_DIGITS,
+  STREAM_POINT,
+  STREAM_SUFFIX,
+  STREAM_DONE
+};
+
+// Sets up the stream to print the digits of d from the first nonzero digit (or position 0 if
+// fixed is true) down to position first - precision (or -precision), rounded half to even. The
+// decimal point follows position 0 for d2fixed, and the first digit for d2exp, which also gets
+// an exponent.
+static void stream_init(ryu_stream* const stream, const double d, const uint32_t precision, const bool fixed) {
+  const uint64_t bits = double_to_bits(d);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+
+  stream->stage = STREAM_PREFIX;
+  stream->offset = 0;
+  stream->prefixLength = 0;
+  stream->suffixLength = 0;
+  stream->carry = INT32_MIN;
+  stream->block = INT32_MIN;
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    stream->prefixLength = (uint8_t) copy_special_str_printf(stream->prefix, ieeeSign, ieeeMantissa);
+    // No digits.
+    stream->m2 = 0;
+    stream->e2 = 0;
+    stream->position = -1;
+    stream->last = 0;
+    stream->point = 0;
+    return;
+  }
+  if (ieeeSign) {
+    stream->prefix[stream->prefixLength++] = '-';
+  }
+
+  uint64_t m2;
+  int32_t e2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  }
+  stream->m2 = m2;
+  stream->e2 = e2;
+
+  block_cache cache = { INT32_MIN, 0 };
+  // Find the first nonzero digit.
+  int32_t first = 0;
+  if (m2 != 0) {
+    int32_t k = e2 >= -52 ? (int32_t) lengthForIndex(e2 < 0 ? 0 : indexForExponent((uint32_t) e2)) - 1 : -1;
+    if (k < 0 && !fixed) {
+      // Skip the fractional blocks that are always zero for this exponent.
+      k = -1 - MIN_BLOCK_2[-e2 / 16];
+    }
+    // For d2exp, this always terminates because m2 is nonzero.
+    for (; !fixed || k >= 0; --k) {
+      const uint32_t digits = cachedDigitBlock(&cache, m2, e2, k);
+      if (digits != 0) {
+        first = 9 * k + (int32_t) decimalLength9(digits) - 1;
+        break;
+      }
+    }
+  }
+  if (fixed && first < 0) {
+    // d2fixed always prints the digit before the decimal point.
+    first = 0;
+  }
+  int32_t last = fixed ? -(int32_t) precision : first - (int32_t) precision;
+#ifdef RYU_DEBUG
+  printf("first=%d last=%d\n", first, last);
+#endif
+
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = 0;
+  const uint32_t lastDigit = m2 == 0 ? 0 : digitsFrom(&cache, m2, e2, last - 1) % 10;
+  if (lastDigit != 5) {
+    roundUp = lastDigit > 5;
+  } else {
+    // Is m2 * 2^e2 * 10^(1 - last) integer?
+    const int32_t rexp = 1 - last;
+    const int32_t requiredTwos = -e2 - rexp;
+    bool trailingZeros = requiredTwos <= 0
+      || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
+    if (rexp < 0) {
+      trailingZeros = trailingZeros && multipleOfPowerOf5(m2, (uint32_t) -rexp);
+    }
+    roundUp = trailingZeros ? 2 : 1;
+  }
+  if (roundUp == 2) {
+    roundUp = (digitsFrom(&cache, m2, e2, last) & 1) != 0;
+  }
+  if (roundUp != 0) {
+    // Find the last digit that is not a 9; it gets incremented, and the 9s after it become 0s.
+    int32_t position = last;
+    while (stream->carry == INT32_MIN) {
+      uint32_t digits = digitsFrom(&cache, m2, e2, position);
+      const int32_t blockEnd = 9 * (blockForPosition(position) + 1);
+      for (; position < blockEnd && position <= first; ++position, digits /= 10) {
+        if (digits % 10 != 9) {
+          stream->carry = position;
+          break;
+        }
+      }
+      if (position > first) {
+        // All digits are 9s, so we print a 1 followed by 0s, which is one digit longer for d2fixed.
+        // For d2exp, the exponent increases by one instead.
+        stream->carry = first + 1;
+        ++first;
+        if (!fixed) {
+          ++last;
+        }
+      }
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("roundUp=%d carry=%d\n", roundUp, stream->carry);
+#endif
+
+  stream->position = first;
+  stream->last = last;
+  stream->point = fixed ? 0 : first;
+  if (blockForPosition(first) == cache.k) {
+    renderBlock(stream, cache.k, cache.digits);
+  }
+  if (!fixed) {
+    stream->suffixLength = (uint8_t) append_exponent(first, stream->suffix);
+  }
+}
+
+void d2fixed_stream_init(ryu_stream* stream, double d, uint32_t precision) {
+  stream_init(stream, d, precision, true);
+}
+
+void d2exp_stream_init(ryu_stream* stream, double d, uint32_t precision) {
+  stream_init(stream, d, precision, false);
+}
+
+int ryu_stream_next(ryu_stream* stream, char* result, int size) {
+  int index = 0;
+  while (index < size) {
+    switch (stream->stage) {
+    case STREAM_PREFIX: {
+      int count = stream->prefixLength - stream->offset;
+      if (count > size - index) {
+        count = size - index;
+      }
+      memcpy(result + index, stream->prefix + stream->offset, (size_t) count);
+      index += count;
+      stream->offset = (uint8_t) (stream->offset + count);
+      if (stream->offset == stream->prefixLength) {
+        stream->offset = 0;
+        stream->stage = stream->position >= stream->last ? STREAM_DIGITS : STREAM_DONE;
+      }
+      break;
+    }
+    case STREAM_DIGITS: {
+      // m2 * 2^e2 has no nonzero digits below position min(e2, 0), so we can skip the
+      // multiplications, unless rounding changes one of these digits.
+      if (stream->position < 0 && stream->position < stream->e2
+          && (stream->carry == INT32_MIN || stream->position < stream->carry)) {
+        int32_t count = stream->position - stream->last + 1;
+        if (count > size - index) {
+          count = size - index;
+        }
+        memset(result + index, '0', (size_t) count);
+        index += count;
+        stream->position -= count;
+        if (stream->position < stream->last) {
+          stream->stage = STREAM_SUFFIX;
+        }
+        break;
+      }
+      const int32_t k = blockForPosition(stream->position);
+      if (k != stream->block) {
+        renderBlock(stream, k, digitBlock(stream->m2, stream->e2, k));
+      }
+      // Copy digits from this block, but not past the decimal point or the last digit.
+      const int32_t o = stream->position - 9 * k;
+      int32_t count = o + 1;
+      if (stream->position >= stream->point && count > stream->position - stream->point + 1) {
+        count = stream->position - stream->point + 1;
+      }
+      if (count > stream->position - stream->last + 1) {
+        count = stream->position - stream->last + 1;
+      }
+      if (count > size - index) {
+        count = size - index;
+      }
+      memcpy(result + index, stream->blockChars + 8 - o, (size_t) count);
+      index += count;
+      stream->position -= count;
+      if (stream->position < stream->last) {
+        stream->stage = STREAM_SUFFIX;
+      } else if (stream->position == stream->point - 1) {
+        stream->stage = STREAM_POINT;
+      }
+      break;
+    }
+    case STREAM_POINT:
+      result[index++] = '.';
+      stream->stage = STREAM_DIGITS;
+      break;
+    case STREAM_SUFFIX: {
+      int count = stream->suffixLength - stream->offset;
+      if (count > size - index) {
+        count = size - index;
+      }
+      memcpy(result + index, stream->suffix + stream->offset, (size_t) count);
+      index += count;
+      stream->offset = (uint8_t) (stream->offset + count);
+      if (stream->offset == stream->suffixLength) {
+        stream->stage = STREAM_DONE;
+      }
+      break;
+    }
+    default:
+      return index;
+    }
+  }
+  return index;
+}
@@ -1258,29 +1258,6 @@ static const uint64_t POW10_SPLIT[1224][3] = {
   {  8310173728816391804u,               197658u,                    0u },
 };
 
-#define TABLE_SIZE_2 69
-#define ADDITIONAL_BITS_2 120
-
-static const uint16_t POW10_OFFSET_2[TABLE_SIZE_2] = {
-     0,    2,    6,   12,   20,   29,   40,   52,   66,   80,
-    95,  112,  130,  150,  170,  192,  215,  240,  265,  292,
-   320,  350,  381,  413,  446,  480,  516,  552,  590,  629,
-   670,  712,  755,  799,  845,  892,  940,  989, 1040, 1092,
-  1145, 1199, 1254, 1311, 1369, 1428, 1488, 1550, 1613, 1678,
-  1743, 1810, 1878, 1947, 2017, 2088, 2161, 2235, 2311, 2387,
-  2465, 2544, 2625, 2706, 2789, 2873, 2959, 3046, 3133
-};
-
-static const uint8_t MIN_BLOCK_2[TABLE_SIZE_2] = {
-     0,    0,    0,    0,    0,    0,    1,    1,    2,    3,
-     3,    4,    4,    5,    5,    6,    6,    7,    7,    8,
-     8,    9,    9,   10,   11,   11,   12,   12,   13,   13,
-    14,   14,   15,   15,   16,   16,   17,   17,   18,   19,
-    19,   20,   20,   21,   21,   22,   22,   23,   23,   24,
-    24,   25,   26,   26,   27,   27,   28,   28,   29,   29,
-    30,   30,   31,   31,   32,   32,   33,   34,    0
-};
-
 static const uint64_t POW10_SPLIT_2[3133][3] = {
   {                    0u,                    0u,              3906250u },
   {                    0u,                    0u,         202000000000u },
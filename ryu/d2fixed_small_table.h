@@ -0,0 +1,416 @@
+// Copyright 2019 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_D2FIXED_SMALL_TABLE_H
+#define RYU_D2FIXED_SMALL_TABLE_H
+
+#include <assert.h>
+#include <stdint.h>
+
+// Defines HAS_UINT128 and uint128_t if applicable.
+#include "ryu/d2s_intrinsics.h"
+
+// These tables are generated by PrintPrintfLookupTable. Instead of storing every entry of
+// POW10_SPLIT and POW10_SPLIT_2 (see d2fixed_full_table.h), we store enough information to compute
+// them exactly, in about 6 KB instead of about 100 KB.
+//
+// A POW10_SPLIT entry is (floor(2^(16 * idx + 120) / 10^(9 * i)) + 1) mod (5^9 * 2^145). For
+// each i, POW10_SPLIT_BITS has floor(2^1128 / 10^(9 * i)), from which we take the low 145 bits
+// after shifting right by 16 * (63 - idx). The bits above only matter mod 5^9, and we store that
+// for every fourth idx in POW10_SPLIT_HIGH.
+//
+// A POW10_SPLIT_2 entry is floor(5^9 * (5^(9 * i) mod 2^w) * 2^(145 - w)), with
+// w = 16 * (idx + 1) - 9 * i. POW10_SPLIT_2_ANCHORS has 5^(36 * a) modulo a power of two that
+// is large enough for every entry with i / 4 == a, which we multiply by 5^(9 * (i % 4)).
+
+static const uint16_t POW10_SPLIT_BITS_OFFSET[37] = {
+     0,   18,   36,   53,   70,   86,  102,  117,  132,  146,
+   160,  173,  186,  199,  211,  223,  234,  245,  255,  265,
+   274,  283,  291,  299,  306,  313,  319,  325,  331,  336,
+   341,  345,  349,  352,  355,  357,  359
+};
+
+static const uint64_t POW10_SPLIT_BITS[359] = {
+                     0u,                    0u,                    0u,
+                     0u,                    0u,                    0u,
+                     0u,                    0u,                    0u,
+                     0u,                    0u,                    0u,
+                     0u,                    0u,                    0u,
+                     0u,                    0u,        1099511627776u,
+   6288709332106746356u, 12323704802554838153u,  6260469580539185877u,
+   8480737406125178271u, 17572520700934791415u,  7408146306870995753u,
+   8634592106137071312u,  4515791283442995453u,  9323915941641553424u,
+   7568423425299591512u, 15268761435931663694u,   589096329272056761u,
+   2517285787892561599u,  4128368337188369760u, 13484604155038683036u,
+   4635408826454083566u,  9437866644873197963u,                 1099u,
+   9066785620141948672u,  7135886931147821731u, 17818573101084525840u,
+  10947205650755620360u, 17968798858233825416u,  8299024588195267961u,
+  12626356501369830730u, 13306155670047701345u, 12155831029092699563u,
+  16561505984665207376u,  5016238054648555437u,  7097729792403256903u,
+   4338831817635138102u, 10240941003671005055u,  8356963862052375698u,
+  12367138975830625352u,       20282409603651u,
+   8442375916704414908u, 15341283120292884946u,  2201029069927307149u,
+    868577942165647780u, 15338423313945305608u,  1497052939192040880u,
+   4803333258178976932u,  4456930152933417600u, 17397171276588232675u,
+   4329114621856906244u, 14236047313993899749u,  8553736750439287019u,
+   1561495325934523195u, 17933378316822368250u,  5850852848337610020u,
+   7555853734021184431u,                20282u,
+  11604629218100425802u,  3092789040392634165u, 10397997613804897038u,
+  16017710019091388478u, 17895321323836726300u, 16771714264265803746u,
+  13613083223558209296u,  9089157128546489636u, 11874560617553253768u,
+   1477500474861899138u,  6957759675154690847u,  2114152625261065695u,
+  12262635050079398785u,  8346249813075698615u,  2712780827214982049u,
+       374144419156711u,
+   3877248044010875761u,  8811761390822097864u, 14269915965770103740u,
+   6610879150827623374u,   814069333008965772u,   142988846654429431u,
+  16106967997237446988u, 12437332180345515839u, 13444839516837727953u,
+  16891579639263969683u, 18439367135478514472u,  9817523680007641223u,
+  11144065765517284187u, 15906203609160902694u,  7732076577307618051u,
+                374144u,
+  16435137704395217282u, 16870860798610218168u, 16776139909196366726u,
+  12110095866223762091u,  7200328959852723946u, 11839838367716104144u,
+  14832921244380020169u,  3433060408790452523u, 16994416043584590670u,
+   4684451357140027419u,  8539004472540641040u, 13047215537500048014u,
+   1212260522471875710u, 14525607416135386327u,     6901746346790563u,
+  14994442577577813270u, 17452041453591904832u,  6246513436385199719u,
+   7756802952949470774u,   759884557248133772u,  6019646776647679764u,
+  13774024637717231396u,  8275594526021936171u, 15879694502877015729u,
+  14727186580409080708u,  1908462039431738398u, 16755544192002345879u,
+   9695352922247418868u,  6397156777364256319u,              6901746u,
+   4410105917142436088u, 10314783684009874907u,  2926026498821554287u,
+   2941800790804618758u, 13410165861863974850u,  4611972391702034947u,
+   9673012968505228884u,  3846512444641107688u,  4234647645735263358u,
+  15864176859687308833u,   714690453250792145u,  6930119832670648355u,
+   7227025834627242947u,   127314748520905380u,
+   4632574728444936969u,  4932636630789274902u, 15725499391028340981u,
+  11703600274199927521u,  6278452420856351569u, 16447182322205429544u,
+   5391832334264815666u,  6210962618469046249u,  7978589901512919495u,
+   1755486942842684437u, 13782189447673929632u, 14560698131901886166u,
+   9609008238705447828u,            127314748u,
+   9117147535650050358u, 18143884346082124479u,  8576577277771450826u,
+    806737539257940345u,  9072115382556676441u,  2113477168726764244u,
+  16514436292632703087u,  7272858906616296574u,  6114237175390859893u,
+  17417077516652710040u,  3584742913798803163u, 16408020927503338034u,
+   2348542582773833227u,
+    588939301256904808u,  2823209155405527321u, 15523351176022259334u,
+  14579028397110132022u,  2755882551854926562u,  3536261187802311515u,
+  12025036352783454152u,  3710743300451225346u,  8658612872088282707u,
+   4290982361913532782u,  4347581515245125290u, 14274703510609809115u,
+            2348542582u,
+    324393982565305682u, 16195396106620226250u,  4775158829429176133u,
+  14247808875344366933u,  8496072611504649268u, 18444381860986709853u,
+   7059867105311401049u,  6424677242672030599u, 10253813330683324852u,
+  11826659981004351408u, 16836742268156371391u,  6429475823218628948u,
+                     2u,
+   9380909186923521174u,  1150544491807648943u, 10141817222123532461u,
+   9713379923695279512u,  4122009033579215814u,  4734315730275909837u,
+  12769210631552594669u, 11485842256170301861u, 13289465061747830990u,
+    932930645678090819u, 11764082328865615307u,          43322963970u,
+   4463385697777230216u,  7767455475523884823u, 12847658900242624585u,
+   2246428675703313876u, 10222217724450527220u,  9974936316849658173u,
+   8328873878884556144u,  7355797963557024307u,  4123165538545565411u,
+  12707792781328052616u,  5957633711383291745u,                   43u,
+  16378985502426333807u, 15204378045683991807u, 13708197964460514654u,
+   3549783776592680619u,  2064539481554006324u, 11864423681540657641u,
+   1016565892414238684u,  6358188982569427272u,  7846417485927038480u,
+  16491596426880311905u,         799167628880u,
+  18210894922387834353u, 17239732561718805621u,  1951540006613246931u,
+  12645029747929213032u,  7935605886598063692u,  8207245621417902666u,
+   9662978461927250280u, 12475094728768767401u, 10562273346358018863u,
+   3092207065214166009u,                  799u,
+   1555748035329493204u, 12886430624522800061u,  9979297327280092198u,
+  16279009267476580505u,  7805147585347548428u,  7992526918695295027u,
+  13729967277551868111u, 17288154837907896182u,  2691512658346619119u,
+        14742040721959u,
+   4277055533891898506u, 18162250541178258135u, 15381307706282553683u,
+    343358782242907185u,  5709020905457661272u,  8679354522130259986u,
+   6371593776693359474u,  2983850577727105261u,   751187558544605997u,
+                 14742u,
+  11574429772510874407u, 17028935366700158083u, 10037428657543061176u,
+  10077054739085890320u, 16257370307404906673u,  6065763799692166460u,
+  17617208110845643244u, 13918604635001185934u,      271942652322184u,
+  17391099253493808814u, 16075467823964198636u,  2584877324547208667u,
+  10526715404712173585u, 14971258192939373645u, 18143341109049024975u,
+  14960960225633086796u, 12033220395769876326u,               271942u,
+   5791212393959129881u,  9803858825574498303u,  1126624732730703575u,
+  11438715865125144242u,  1133404845901376389u, 15242492331283350569u,
+  12090634301321662557u,     5016456510113118u,
+  11254268231455680879u, 17464070808143041816u,  1501064139624981019u,
+   5040916178827294800u,  9460827548162822046u,  9986352353182266962u,
+   9409926148478635502u,              5016456u,
+  16355477587312235321u, 17682703471239266775u,  5219661484955306108u,
+  16643761637275849507u,  1273897659779791345u, 17340463289911536076u,
+     92537289398950870u,
+   2411485149249320632u, 18147688354161351335u,  5336997298570282211u,
+   4852542977279030385u,  7833262224435092782u,  7359344614214233034u,
+              92537289u,
+  12763114642070638359u,  6663423873348080050u, 12191131175733833361u,
+   7883373066544387128u,  3033420566713364586u,  1707011694817242694u,
+   1147543073987366418u,  9417270363716235132u,  3707068178994436535u,
+  16699064314768500977u, 15075466825360349102u,           1707011694u,
+   8410777835225272691u,  9295013721571344178u,  5045484691732942021u,
+   6805863634444817213u, 13042063791413317777u,                    1u,
+   8134725822306818017u,  6199479138350037782u, 14847900542908711231u,
+   2266540253968903499u,          31488807865u,
+   8899607004752328376u,   887603005365085687u,  9097257915916965134u,
+   9016913589137908809u,                   31u,
+    690976506652396829u,   333989628642975695u,  2472027983230314216u,
+          580865979874u,
+  12281570945595192073u,  4620735991403939438u, 15974509111133272204u,
+                   580u,
+  12592957291365552898u, 12418523063962801200u,       10715086071862u,
+  13595807339013970271u,  1587745622680169418u,                10715u,
+   9698096389749839991u,      197658450495420u,
+   8310173728816391803u,               197658u
+};
+
+static const uint16_t POW10_SPLIT_HIGH_OFFSET[17] = {
+     0,    4,   10,   18,   28,   40,   55,   72,   91,  112,
+   135,  160,  187,  217,  249,  283,  319
+};
+
+static const uint32_t POW10_SPLIT_HIGH[319] = {
+        0u,       0u,       0u,       0u,
+  1907638u,     549u,       0u,       0u,       0u,       0u,
+   643008u, 1227598u, 1676825u,   10141u,       0u,       0u,       0u,       0u,
+   266553u, 1906584u,  384559u, 1264446u,  593980u,  187072u,       0u,       0u,
+        0u,       0u,
+   571523u,  237512u, 1710193u, 1616179u, 1451012u, 1139252u, 1520281u, 1497748u,
+        0u,       0u,       0u,       0u,
+  1824918u,  416772u, 1308790u,  348139u, 1279257u, 1608387u, 1074317u,  576427u,
+   687065u, 1157374u,       0u,       0u,       0u,       0u,       0u,
+   342488u,  978101u, 1380749u,  663596u,  479512u,  129860u, 1034935u,  341274u,
+   137263u, 1380923u,  197863u,  443166u,       1u,       0u,       0u,       0u,
+        0u,
+  1751233u, 1199779u, 1103210u, 1090453u, 1753172u,  981429u,  947717u, 1793598u,
+   520118u, 1461526u,  653933u, 1282688u,  506715u, 1325735u,      21u,       0u,
+        0u,       0u,       0u,
+    64403u, 1634894u,  153386u,  985230u,  815933u,   19183u,  743692u,  311875u,
+   707568u, 1387707u, 1072934u,  249761u, 1849635u,  695413u, 1693116u, 1783190u,
+      399u,       0u,       0u,       0u,       0u,
+   772123u, 1359460u,  848147u, 1548110u, 1141855u, 1650194u,  732481u, 1499104u,
+  1416362u, 1664230u,  317172u,  586417u,  836672u,  430500u, 1740072u, 1134742u,
+   687971u,  829729u,    7371u,       0u,       0u,       0u,       0u,
+  1307018u, 1289072u, 1664708u,  268347u, 1177064u, 1256413u, 1654189u,  744303u,
+   379729u, 1818735u,  970523u,  313100u,  777503u,  160553u,  464057u,  247495u,
+  1799500u,  799306u,  311409u, 1942342u,  135971u,       0u,       0u,       0u,
+        0u,
+  1619213u,  441203u, 1288358u, 1795860u, 1033367u, 1656510u,  298810u,  468791u,
+  1614658u,  359067u, 1720513u, 1904956u,  407022u, 1145203u,  210323u,  196806u,
+  1057758u,  827395u,  952882u, 1220764u, 1545424u, 1150309u,  555103u,       0u,
+        0u,       0u,       0u,
+  1579458u,  336137u, 1515201u, 1473226u, 1922595u,  606962u, 1053477u,    7762u,
+   489270u,  645288u,  147426u, 1889097u, 1370759u,  839940u, 1273348u, 1754713u,
+  1794126u,  879375u,  350357u, 1541871u, 1039207u, 1149372u, 1264199u,  256685u,
+  1346769u,       0u,       0u,       0u,       0u,       0u,
+  1694753u,  717143u, 1686296u,  678656u,  581018u, 1805932u, 1065462u,  202024u,
+   255918u, 1759555u,  479596u, 1770884u,  399153u, 1683141u, 1271954u,  251278u,
+   621449u,  446446u, 1203780u, 1499891u, 1424124u,  576869u, 1325940u, 1383498u,
+   189779u,  418222u, 1943347u,       0u,       0u,       0u,       0u,       0u,
+  1355223u, 1802728u,  105352u,  567150u, 1453863u,  119806u, 1264190u, 1612670u,
+   820471u,  382289u,  634106u, 1422008u, 1562940u,  342696u,  513957u,  947343u,
+  1790305u, 1494258u, 1654741u,  170942u, 1453264u, 1868681u, 1911313u,  669065u,
+   788630u, 1457170u,  879553u,  887821u,  263307u,      15u,       0u,       0u,
+        0u,       0u,
+  1721618u,  551516u, 1065262u,  588290u,   68097u, 1593183u, 1343335u, 1185107u,
+   459265u,   46717u,  839401u,  524689u, 1457006u,  580242u,  467700u,  162222u,
+   958146u,  895555u,  580673u, 1703865u, 1240349u, 1623925u,  854208u,  128351u,
+   363147u,  870909u,   39386u,  109400u,  487919u,  598202u, 1349312u,     290u,
+        0u,       0u,       0u,       0u
+};
+
+static const uint16_t POW10_SPLIT_2_ANCHORS_OFFSET[32] = {
+     0,    3,    7,   12,   19,   27,   37,   48,   60,   73,
+    85,   97,  108,  119,  129,  139,  148,  156,  164,  171,
+   178,  184,  190,  195,  200,  204,  207,  210,  212,  214,
+   215,  216
+};
+
+static const uint64_t POW10_SPLIT_2_ANCHORS[216] = {
+                     1u,                    0u,                    0u,
+  16698380334918842865u,               788860u,                    0u,
+                     0u,
+  18316647450161853665u,  2106077949367544134u,         622301527786u,
+                     0u,                    0u,
+  11457148413585547473u, 12590478334395027142u,  5710691296419931300u,
+    490909346529772655u,                    0u,                    0u,
+                     0u,
+  13142907561237294529u, 15012915935620909864u,  8626481361138331845u,
+   1168207125790530789u,  6693145547210207115u,                20993u,
+                     0u,                    0u,
+  13207932011069017009u, 13575919721811806401u, 17811171573157153437u,
+   7926730560699156048u,  6673478215062529759u, 10259900813219811961u,
+           16560843210u,                    0u,                    0u,
+                     0u,
+   8688505427903736481u,  3147220002440857300u,  8463862715901576300u,
+   9490907630136752916u, 17841343440958328027u, 11863110253260222498u,
+  13284322918167594445u,    13064201766302603u,                    0u,
+                     0u,                    0u,
+   6367680734019697297u,  8207196563870326731u, 10885341906669388464u,
+   9921431079370478095u, 10835281145254685536u,  6888475103237214235u,
+   2225366356289183175u,  4766738099622525079u, 12554838225483491435u,
+                   558u,                    0u,                    0u,
+    792478769211075457u,  9511335878798620707u, 12802697721526339408u,
+   9401145187231568770u,  9023980117402305551u,  4069250660416542207u,
+   2180080595215225784u, 16801844099710515453u, 10232149913123443095u,
+   3138241419126269405u,            440721283u,                    0u,
+                     0u,
+  17421236337928203633u, 12043333284236872275u,  4396983155938718698u,
+   7663119272245473343u,  5318577050781876769u, 13389660517304733633u,
+  14437530170181752189u, 11210225627339459486u, 13656424769326288417u,
+  10205880825701620129u,  3986486180278752518u,      347667790391750u,
+  13894168943295705185u,  4601291730423121377u, 16312515716494630702u,
+  11210627174210626524u, 13385510793074798805u,  6926286827289840501u,
+   8325416539745948522u,  3154431617534062973u, 17087985777033767391u,
+   8005510553372365574u,  3917696829526085083u, 14210704790702616218u,
+   2241362334902068305u,  7521156517118832510u,  6066936682872212044u,
+  17377681681380199875u,  6684039772113500884u, 10780532503427815637u,
+  16632299965462361633u,  2733888052398132284u,  1027663061621000330u,
+  15545964435582715592u, 13025325109018131682u,
+   9919726386361907521u,  4630289419283684731u, 11654214312702319081u,
+  10984660978606903562u, 16424365659841183319u, 13590481813851882819u,
+   5543310244362305101u,  3883019953012795806u,   533459625314589732u,
+  15086276895428384221u, 17935562173010865467u,
+  14434833115849252657u,  8444971128061616056u, 18405474743648690127u,
+    375569261668050171u, 14202692646539339239u, 15438727418656921021u,
+   4909135886995669763u,  5116582001377749268u, 10604199343812334075u,
+  10782179122100725776u,
+   2794860281883592225u,   792005346826701645u, 12328812617001239444u,
+   8877887560294980515u, 15910893124677544709u,  3257189215046584509u,
+   6733958494847390772u, 14787464248751217597u, 16766844772497556429u,
+  12777822023231614755u,
+  17645362005824806417u,  6747820481295059293u,  4985290021429520852u,
+   3753600528392698935u,  2136809766885943727u,  8617946403238058022u,
+  17893830975053225862u, 16737793879571182028u,  1724682831329755403u,
+  17479219490827736833u, 15058683930353317572u, 15404258183538082686u,
+  18289345151525270588u,  1167384388957802651u, 12953671010612383616u,
+  14239508374947615890u, 14118442728696427781u,
+  16412948681908052209u,  8305792213887787562u, 18366640090555091585u,
+  15818013415106252697u, 10108769523345649312u,  4047878744639647732u,
+    142739569362064142u,  8526496040287333749u,
+   7758835715193269217u, 13257749746581255500u, 16505942145872588169u,
+   4593380466519703278u,  6910116424372647153u,  3447584022400118677u,
+   7415631776321815531u,
+    660051656858413009u,  5827600289899996418u,  6735634311240562351u,
+   4124734711145967014u, 17148677296368607971u,   265627706748867319u,
+  18315332123699743827u,
+  13931818819905619137u, 16208091741834167243u,   941448444501371958u,
+  15016047310179178196u,  3204762558153229925u,  2389160694469735858u,
+  10599690489219478193u,  3060542355007847796u,  7355904880408958526u,
+   6725949803375588152u,   162630806389872251u,  4706287582595579721u,
+  17324462585194799521u, 18118642609460438969u,   154438799943119608u,
+  12926010544311283981u,  3761653203467782653u,
+  10113370436363993489u, 14012148162246467128u, 14100708997945062734u,
+   7248418582236891025u, 16643468634754746821u,
+  16287545861907743361u, 11212714443130810102u,  6692547721635841965u,
+  16045140797449392422u,
+  12883062796771300465u, 14334052092327476654u,  9986738139429805312u,
+   1378519212560967521u,  3111530463755196557u,  8230309298839836247u,
+   6400375826450836305u,  8262743773979728501u,
+  12116242287960232001u,   959602244015517524u,
+  11097566056321500721u,
+  18265176662931995937u
+};
+
+// 5^(9 * d) for 0 <= d < 4.
+static const uint64_t POW5_9D[4] = { 1u, 1953125u, 3814697265625u, 7450580596923828125u };
+
+// 2^(16 * d) mod 5^9 for 0 <= d < 4.
+static const uint32_t POW2_16D_MOD_POW5_9[4] = { 1u, 65536u, 45421u, 148156u };
+
+// Returns bits [pos, pos + 64) of the number with the little-endian limbs v[0, n). Bits outside of
+// the limbs are 0, and pos may be negative.
+static inline uint64_t bitsAt(const uint64_t* const v, const int32_t n, const int32_t pos) {
+  // Add a multiple of 64 to avoid dividing negative numbers.
+  const int32_t k = (pos + 256) / 64 - 4;
+  const uint32_t shift = (uint32_t) (pos + 256) % 64;
+  const uint64_t lo = k >= 0 && k < n ? v[k] : 0;
+  if (shift == 0) {
+    return lo;
+  }
+  const uint64_t hi = k + 1 >= 0 && k + 1 < n ? v[k + 1] : 0;
+  return (lo >> shift) | (hi << (64 - shift));
+}
+
+// Returns the low 64 bits of a * b + *carry, and stores the high 64 bits in *carry.
+static inline uint64_t mulAdd64(const uint64_t a, const uint64_t b, uint64_t* const carry) {
+#if defined(HAS_UINT128)
+  const uint128_t product = ((uint128_t) a) * b + *carry;
+  *carry = (uint64_t) (product >> 64);
+  return (uint64_t) product;
+#else
+  uint64_t high;
+  const uint64_t low = umul128(a, b, &high);
+  const uint64_t sum = low + *carry;
+  *carry = high + (sum < low);
+  return sum;
+#endif
+}
+
+// Computes POW10_SPLIT[POW10_OFFSET[idx] + i], and stores it in the given pointer.
+static inline void computePow10Split(const uint32_t idx, const uint32_t i, uint64_t* const result) {
+  const uint64_t* const bits = POW10_SPLIT_BITS + POW10_SPLIT_BITS_OFFSET[i];
+  const int32_t n = POW10_SPLIT_BITS_OFFSET[i + 1] - POW10_SPLIT_BITS_OFFSET[i];
+  const int32_t shift = 16 * (63 - (int32_t) idx);
+  // Shift the high part of the anchor left by 16 * d bits, pulling in the bits from below.
+  const uint32_t d = idx % 4;
+  uint64_t high = POW10_SPLIT_HIGH[POW10_SPLIT_HIGH_OFFSET[idx / 4] + i];
+  if (d != 0) {
+    const uint64_t next = bitsAt(bits, n, shift + 145) & ((1ull << (16 * d)) - 1);
+    high = (high * POW2_16D_MOD_POW5_9[d] + next) % 1953125;
+  }
+  // Add 1 to the low 145 bits, carrying into the high part if necessary.
+  const uint64_t low0 = bitsAt(bits, n, shift) + 1;
+  const uint64_t low1 = bitsAt(bits, n, shift + 64) + (low0 == 0);
+  uint64_t low2 = (bitsAt(bits, n, shift + 128) & 0x1ffff) + (low0 == 0 && low1 == 0);
+  if (low2 > 0x1ffff) {
+    low2 = 0;
+    high = (high + 1) % 1953125;
+  }
+  result[0] = low0;
+  result[1] = low1;
+  result[2] = low2 | (high << 17);
+}
+
+// Computes POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]], and stores it in the given
+// pointer.
+static inline void computePow10Split2(const uint32_t idx, const uint32_t i, uint64_t* const result) {
+  const int32_t w = 16 * ((int32_t) idx + 1) - 9 * (int32_t) i;
+  assert(w > 0);
+  const int32_t n = (w + 63) / 64;
+  const uint64_t* const anchor = POW10_SPLIT_2_ANCHORS + POW10_SPLIT_2_ANCHORS_OFFSET[i / 4];
+  assert(n <= POW10_SPLIT_2_ANCHORS_OFFSET[i / 4 + 1] - POW10_SPLIT_2_ANCHORS_OFFSET[i / 4]);
+  // w is at most 782, so we need at most 13 limbs for 5^(9 * i) mod 2^w, and one more after
+  // multiplying by 5^9.
+  uint64_t x[14];
+  const uint64_t m = POW5_9D[i % 4];
+  const uint64_t mask = w % 64 == 0 ? ~0ull : (1ull << (w % 64)) - 1;
+  uint64_t carry = 0;
+  uint64_t carry2 = 0;
+  for (int32_t k = 0; k < n; ++k) {
+    uint64_t limb = mulAdd64(anchor[k], m, &carry);
+    if (k == n - 1) {
+      limb &= mask;
+    }
+    x[k] = mulAdd64(limb, POW5_9D[1], &carry2);
+  }
+  x[n] = carry2;
+  result[0] = bitsAt(x, n + 1, w - 145);
+  result[1] = bitsAt(x, n + 1, w - 145 + 64);
+  result[2] = bitsAt(x, n + 1, w - 145 + 128);
+}
+
+#endif // RYU_D2FIXED_SMALL_TABLE_H
@@ -26,6 +26,10 @@
 //     intermediate values with a multiplication. This reduces the lookup table
 //     size by about 10x (only one case, and only double) at the cost of some
 //     performance. Currently requires MSVC intrinsics.
+//
+// -DRYU_NO_SIMD Don't use the SSE2/SSSE3 code path in to_chars or the AVX2 or
+//     AVX-512 code path in d2s_batch, even if the compiler targets these
+//     instruction sets (e.g., with -march=native).
 
 #include "ryu/ryu.h"
 
@@ -42,6 +46,7 @@
 
 #include "ryu/common.h"
 #include "ryu/digit_table.h"
+#include "ryu/digit_simd.h"
 #include "ryu/d2s_intrinsics.h"
 
 // Include either the small or the full lookup tables depending on the mode.
@@ -50,17 +55,21 @@
 #else
 #include "ryu/d2s_full_table.h"
 #endif
+#include "ryu/d2s_simd.h"
 
 #define DOUBLE_MANTISSA_BITS 52
 #define DOUBLE_EXPONENT_BITS 11
 #define DOUBLE_BIAS 1023
 
 static inline uint32_t decimalLength17(const uint64_t v) {
-  // This is slightly faster than a loop.
-  // The average output length is 16.38 digits, so we check high-to-low.
   // Function precondition: v is not an 18, 19, or 20-digit number.
   // (17 digits are sufficient for round-tripping.)
   assert(v < 100000000000000000L);
+#if defined(HAS_BIT_SCAN)
+  return decimalLengthBitScan(v);
+#else
+  // This is slightly faster than a loop.
+  // The average output length is 16.38 digits, so we check high-to-low.
   if (v >= 10000000000000000L) { return 17; }
   if (v >= 1000000000000000L) { return 16; }
   if (v >= 100000000000000L) { return 15; }
@@ -78,16 +87,9 @@ static inline uint32_t decimalLength17(const uint64_t v) {
   if (v >= 100L) { return 3; }
   if (v >= 10L) { return 2; }
   return 1;
+#endif
 }
 
-// A floating decimal representing m * 10^e.
-typedef struct floating_decimal_64 {
-  uint64_t mantissa;
-  // Decimal exponent's range is -324 to 308
-  // inclusive, and can fit in a short if needed.
-  int32_t exponent;
-} floating_decimal_64;
-
 static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
   int32_t e2;
   uint64_t m2;
@@ -311,30 +313,37 @@ static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_
   return fd;
 }
 
-static inline int to_chars(const floating_decimal_64 v, const bool sign, char* const result) {
-  // Step 5: Print the decimal representation.
-  int index = 0;
-  if (sign) {
-    result[index++] = '-';
-  }
-
-  uint64_t output = v.mantissa;
-  const uint32_t olength = decimalLength17(output);
-
-#ifdef RYU_DEBUG
-  printf("DIGITS=%" PRIu64 "\n", v.mantissa);
-  printf("OLEN=%u\n", olength);
-  printf("EXP=%u\n", v.exponent + olength);
-#endif
-
+// Prints the olength digits of output to result[0] and result[2] to result[olength], leaving room
+// for a decimal dot in result[1].
+static inline void to_chars_significand_digits(uint64_t output, const uint32_t olength, char* const result) {
   // Print the decimal digits.
   // The following code is equivalent to:
   // for (uint32_t i = 0; i < olength - 1; ++i) {
   //   const uint32_t c = output % 10; output /= 10;
-  //   result[index + olength - i] = (char) ('0' + c);
+  //   result[olength - i] = (char) ('0' + c);
   // }
-  // result[index] = '0' + output % 10;
-
+  // result[0] = '0' + output % 10;
+
+#if defined(HAS_SSE2)
+  // Convert all 17 digit positions at once, and then move the olength significant digits into
+  // place. This writes up to 16 bytes past the first digit; anything after the last digit is
+  // overwritten by the exponent, or is past the end of the string.
+  const uint64_t q = div1e8(output);
+  const uint32_t output2 = ((uint32_t) output) - 100000000 * ((uint32_t) q);
+  // q has at most 9 digits.
+  const uint32_t first = ((uint32_t) q) / 100000000;
+  const uint32_t output3 = ((uint32_t) q) - 100000000 * first;
+  const __m128i digits = digits16(output3, output2);
+  if (olength == 17) {
+    result[0] = (char) ('0' + first);
+    storeDigits16(result + 2, digits, 0);
+  } else {
+    // Write the first digit to result[1] and move it to the front; the decimal dot goes
+    // where it was.
+    storeDigits16(result + 1, digits, 16 - olength);
+    result[0] = result[1];
+  }
+#else
   uint32_t i = 0;
   // We prefer 32-bit operations, even on 64-bit platforms.
   // We have at most 17 digits, and uint32_t can store 9 digits.
@@ -353,10 +362,10 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
     const uint32_t c1 = (c / 100) << 1;
     const uint32_t d0 = (d % 100) << 1;
     const uint32_t d1 = (d / 100) << 1;
-    memcpy(result + index + olength - 1, DIGIT_TABLE + c0, 2);
-    memcpy(result + index + olength - 3, DIGIT_TABLE + c1, 2);
-    memcpy(result + index + olength - 5, DIGIT_TABLE + d0, 2);
-    memcpy(result + index + olength - 7, DIGIT_TABLE + d1, 2);
+    memcpy(result + olength - 1, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - 3, DIGIT_TABLE + c1, 2);
+    memcpy(result + olength - 5, DIGIT_TABLE + d0, 2);
+    memcpy(result + olength - 7, DIGIT_TABLE + d1, 2);
     i += 8;
   }
   uint32_t output2 = (uint32_t) output;
@@ -369,36 +378,41 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
     output2 /= 10000;
     const uint32_t c0 = (c % 100) << 1;
     const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + index + olength - i - 1, DIGIT_TABLE + c0, 2);
-    memcpy(result + index + olength - i - 3, DIGIT_TABLE + c1, 2);
+    memcpy(result + olength - i - 1, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 3, DIGIT_TABLE + c1, 2);
     i += 4;
   }
   if (output2 >= 100) {
     const uint32_t c = (output2 % 100) << 1;
     output2 /= 100;
-    memcpy(result + index + olength - i - 1, DIGIT_TABLE + c, 2);
+    memcpy(result + olength - i - 1, DIGIT_TABLE + c, 2);
     i += 2;
   }
   if (output2 >= 10) {
     const uint32_t c = output2 << 1;
     // We can't use memcpy here: the decimal dot goes between these two digits.
-    result[index + olength - i] = DIGIT_TABLE[c + 1];
-    result[index] = DIGIT_TABLE[c];
+    result[olength - i] = DIGIT_TABLE[c + 1];
+    result[0] = DIGIT_TABLE[c];
   } else {
-    result[index] = (char) ('0' + output2);
+    result[0] = (char) ('0' + output2);
   }
+#endif
+}
 
+// Prints the olength digits of output, with a decimal dot after the first digit if olength > 1.
+static inline int to_chars_significand(const uint64_t output, const uint32_t olength, char* const result) {
+  to_chars_significand_digits(output, olength, result);
   // Print decimal point if needed.
   if (olength > 1) {
-    result[index + 1] = '.';
-    index += olength + 1;
-  } else {
-    ++index;
+    result[1] = '.';
+    return (int) olength + 1;
   }
+  return 1;
+}
 
-  // Print the exponent.
-  result[index++] = 'E';
-  int32_t exp = v.exponent + (int32_t) olength - 1;
+// Prints exp, preceded by a minus sign if it is negative.
+static inline int to_chars_exponent(int32_t exp, char* const result) {
+  int index = 0;
   if (exp < 0) {
     result[index++] = '-';
     exp = -exp;
@@ -415,10 +429,200 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
   } else {
     result[index++] = (char) ('0' + exp);
   }
+  return index;
+}
+
+static inline int to_chars(const floating_decimal_64 v, const bool sign, char* const result) {
+  // Step 5: Print the decimal representation.
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  const uint64_t output = v.mantissa;
+  const uint32_t olength = decimalLength17(output);
+
+#ifdef RYU_DEBUG
+  printf("DIGITS=%" PRIu64 "\n", v.mantissa);
+  printf("OLEN=%u\n", olength);
+  printf("EXP=%u\n", v.exponent + olength);
+#endif
+
+  index += to_chars_significand(output, olength, result + index);
 
+  // Print the exponent.
+  result[index++] = 'E';
+  index += to_chars_exponent(v.exponent + (int32_t) olength - 1, result + index);
   return index;
 }
 
+// Same as to_chars, but writes the sign and the decimal dot unconditionally, and overwrites them if
+// they are not needed. This writes up to 25 bytes, some of which may be past the returned length.
+//
+// A branch-free exponent writer (computing the hundreds digit by multiplication and always storing
+// three digits) was measurably slower than to_chars_exponent, even for random exponents.
+static inline int to_chars_slack(const floating_decimal_64 v, const bool sign, char* const result) {
+  result[0] = '-';
+  int index = sign;
+  const uint32_t olength = decimalLength17(v.mantissa);
+  to_chars_significand_digits(v.mantissa, olength, result + index);
+  // For olength == 1, the exponent character overwrites the decimal dot.
+  result[index + 1] = '.';
+  index += (int) olength + (olength > 1);
+  result[index++] = 'E';
+  return index + to_chars_exponent(v.exponent + (int32_t) olength - 1, result + index);
+}
+
+// Writes the olength decimal digits of output to result.
+static inline void writeDigits17(uint64_t output, const uint32_t olength, char* const result) {
+  uint32_t i = 0;
+  if ((output >> 32) != 0) {
+    // Expensive 64-bit division.
+    const uint64_t q = div1e8(output);
+    uint32_t output2 = ((uint32_t) output) - 100000000 * ((uint32_t) q);
+    output = q;
+
+    const uint32_t c = output2 % 10000;
+    output2 /= 10000;
+    const uint32_t d = output2 % 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    const uint32_t d0 = (d % 100) << 1;
+    const uint32_t d1 = (d / 100) << 1;
+    memcpy(result + olength - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - 4, DIGIT_TABLE + c1, 2);
+    memcpy(result + olength - 6, DIGIT_TABLE + d0, 2);
+    memcpy(result + olength - 8, DIGIT_TABLE + d1, 2);
+    i += 8;
+  }
+  uint32_t output2 = (uint32_t) output;
+  while (output2 >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = output2 - 10000 * (output2 / 10000);
+#else
+    const uint32_t c = output2 % 10000;
+#endif
+    output2 /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
+    i += 4;
+  }
+  if (output2 >= 100) {
+    const uint32_t c = (output2 % 100) << 1;
+    output2 /= 100;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (output2 >= 10) {
+    memcpy(result, DIGIT_TABLE + 2 * output2, 2);
+  } else {
+    result[0] = (char) ('0' + output2);
+  }
+}
+
+// Prints v in positional notation, e.g., 123.45, 1200, or 0.0012, with the given decimal separator.
+static inline int to_chars_fixed(const floating_decimal_64 v, const bool sign, const char decimalChar,
+  char* const result) {
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  const uint64_t output = v.mantissa;
+  const int32_t olength = (int32_t) decimalLength17(output);
+  // The number of digits before the decimal dot, if positive.
+  const int32_t intLength = olength + v.exponent;
+
+  if (v.exponent >= 0) {
+    // All digits are before the decimal dot, followed by v.exponent zeros.
+    writeDigits17(output, (uint32_t) olength, result + index);
+    memset(result + index + olength, '0', (size_t) v.exponent);
+    return index + intLength;
+  }
+  if (intLength > 0) {
+    // Print the digits one position to the right, and then move the integer part into place.
+    writeDigits17(output, (uint32_t) olength, result + index + 1);
+    memmove(result + index, result + index + 1, (size_t) intLength);
+    result[index + intLength] = decimalChar;
+    return index + olength + 1;
+  }
+  // All digits are after the decimal dot, preceded by -intLength zeros.
+  result[index] = '0';
+  result[index + 1] = decimalChar;
+  memset(result + index + 2, '0', (size_t) -intLength);
+  writeDigits17(output, (uint32_t) olength, result + index + 2 - intLength);
+  return index + 2 - intLength + olength;
+}
+
+// Same as to_chars_fixed, but also inserts separators->group_char between groups of digits in the
+// integer part, which requires it and separators->group_size to be non-zero.
+static inline int to_chars_fixed_grouped(const floating_decimal_64 v, const bool sign,
+  const ryu_separators* const separators, char* const result) {
+  const char groupChar = separators->group_char;
+  const uint32_t groupSize = separators->group_size;
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  const uint64_t output = v.mantissa;
+  const int32_t olength = (int32_t) decimalLength17(output);
+  const int32_t intLength = olength + v.exponent;
+  if (intLength <= 0) {
+    // There is nothing to group.
+    return index + to_chars_fixed(v, false, separators->decimal_char, result + index);
+  }
+
+  char digits[17];
+  writeDigits17(output, (uint32_t) olength, digits);
+  if (v.exponent >= 0) {
+    index += copy_grouped_digits(digits, (uint32_t) olength, (uint32_t) intLength - 1, groupChar, groupSize,
+      result + index);
+    index += copy_grouped_digits(NULL, (uint32_t) v.exponent, (uint32_t) v.exponent - 1, groupChar, groupSize,
+      result + index);
+    return index;
+  }
+  index += copy_grouped_digits(digits, (uint32_t) intLength, (uint32_t) intLength - 1, groupChar, groupSize,
+    result + index);
+  result[index++] = separators->decimal_char;
+  memcpy(result + index, digits + intLength, (size_t) -v.exponent);
+  return index - v.exponent;
+}
+
+// Prints exp with at least format->min_exponent_digits digits, preceded by a minus sign if it is
+// negative, or by a plus sign if it is not and format->exponent_sign is set.
+static inline int to_chars_exponent_format(int32_t exp, const ryu_format* const format, char* const result) {
+  int index = 0;
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else if (format->exponent_sign) {
+    result[index++] = '+';
+  }
+  const uint32_t elength = exp >= 100 ? 3 : exp >= 10 ? 2 : 1;
+  for (uint32_t i = elength; i < format->min_exponent_digits; ++i) {
+    result[index++] = '0';
+  }
+  return index + to_chars_exponent(exp, result + index);
+}
+
+static inline int copy_special_str_format(char* const result, const bool sign, const bool nan,
+  const ryu_format* const format) {
+  if (nan) {
+    const size_t length = strlen(format->nan);
+    memcpy(result, format->nan, length);
+    return (int) length;
+  }
+  if (sign) {
+    result[0] = '-';
+  }
+  const size_t length = strlen(format->infinity);
+  memcpy(result + sign, format->infinity, length);
+  return sign + (int) length;
+}
+
 static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t ieeeExponent,
   floating_decimal_64* const v) {
   const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
@@ -451,7 +655,31 @@ static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t iee
   return true;
 }
 
-int d2s_buffered_n(double f, char* result) {
+// Returns the shortest decimal representation of a finite, nonzero double, as printed by d2s.
+static inline floating_decimal_64 d2d_shortest(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
+  floating_decimal_64 v;
+  const bool isSmallInt = d2d_small_int(ieeeMantissa, ieeeExponent, &v);
+  if (isSmallInt) {
+    // For small integers in the range [1, 2^53), v.mantissa might contain trailing (decimal) zeros.
+    // For scientific notation we need to move these zeros into the exponent.
+    // (This is not needed for fixed-point notation, so it might be beneficial to trim
+    // trailing zeros in to_chars only if needed - once fixed-point notation output is implemented.)
+    for (;;) {
+      const uint64_t q = div10(v.mantissa);
+      const uint32_t r = ((uint32_t) v.mantissa) - 10 * ((uint32_t) q);
+      if (r != 0) {
+        break;
+      }
+      v.mantissa = q;
+      ++v.exponent;
+    }
+  } else {
+    v = d2d(ieeeMantissa, ieeeExponent);
+  }
+  return v;
+}
+
+static inline int d2s_inline(const double f, char* const result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint64_t bits = double_to_bits(f);
 
@@ -472,27 +700,190 @@ int d2s_buffered_n(double f, char* result) {
     return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
   }
 
-  floating_decimal_64 v;
-  const bool isSmallInt = d2d_small_int(ieeeMantissa, ieeeExponent, &v);
-  if (isSmallInt) {
-    // For small integers in the range [1, 2^53), v.mantissa might contain trailing (decimal) zeros.
-    // For scientific notation we need to move these zeros into the exponent.
-    // (This is not needed for fixed-point notation, so it might be beneficial to trim
-    // trailing zeros in to_chars only if needed - once fixed-point notation output is implemented.)
-    for (;;) {
-      const uint64_t q = div10(v.mantissa);
-      const uint32_t r = ((uint32_t) v.mantissa) - 10 * ((uint32_t) q);
-      if (r != 0) {
-        break;
+  const floating_decimal_64 v = d2d_shortest(ieeeMantissa, ieeeExponent);
+  return to_chars(v, ieeeSign, result);
+}
+
+int d2s_buffered_n(double f, char* result) {
+  return d2s_inline(f, result);
+}
+
+int d2s_slack_buffered_n(double f, char* result) {
+  const uint64_t bits = double_to_bits(f);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+  return to_chars_slack(d2d_shortest(ieeeMantissa, ieeeExponent), ieeeSign, result);
+}
+
+int d2s_batch(const double* values, int count, char* result, int* offsets) {
+  // Each output is written directly to its final position in result. Keeping the conversion
+  // inlined into this loop avoids the per-value call overhead and lets the compiler overlap the
+  // table lookups for consecutive values.
+  int index = 0;
+  int i = 0;
+#if defined(HAS_D2S_SIMD)
+  // Run d2d on D2S_SIMD_LANES values at a time, and only use the scalar code for the lanes that the
+  // vector code can't handle.
+  for (; i + D2S_SIMD_LANES <= count; i += D2S_SIMD_LANES) {
+    uint64_t mantissa[D2S_SIMD_LANES];
+    uint64_t exponent[D2S_SIMD_LANES];
+    const uint32_t fallback = d2d_simd(values + i, mantissa, exponent);
+    for (int k = 0; k < D2S_SIMD_LANES; ++k) {
+      offsets[i + k] = index;
+      if ((fallback >> k) & 1) {
+        index += d2s_inline(values[i + k], result + index);
+      } else {
+        floating_decimal_64 v;
+        v.mantissa = mantissa[k];
+        v.exponent = (int32_t) exponent[k];
+        index += to_chars(v, (double_to_bits(values[i + k]) >> 63) != 0, result + index);
       }
-      v.mantissa = q;
-      ++v.exponent;
     }
-  } else {
+  }
+#endif
+  for (; i < count; ++i) {
+    offsets[i] = index;
+    index += d2s_inline(values[i], result + index);
+  }
+  offsets[count] = index;
+  return index;
+}
+
+int d2s_fixed_shortest_buffered_n(double f, char* result) {
+  const uint64_t bits = double_to_bits(f);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    if (ieeeSign) {
+      result[0] = '-';
+    }
+    result[ieeeSign] = '0';
+    return ieeeSign + 1;
+  }
+
+  floating_decimal_64 v;
+  // Small integers are printed as they are, including trailing zeros.
+  if (!d2d_small_int(ieeeMantissa, ieeeExponent, &v)) {
     v = d2d(ieeeMantissa, ieeeExponent);
   }
+  return to_chars_fixed(v, ieeeSign, '.', result);
+}
 
-  return to_chars(v, ieeeSign, result);
+int d2s_fixed_shortest_grouped_buffered_n(double f, const ryu_separators* separators, char* result) {
+  const uint64_t bits = double_to_bits(f);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+    return d2s_fixed_shortest_buffered_n(f, result);
+  }
+
+  floating_decimal_64 v;
+  if (!d2d_small_int(ieeeMantissa, ieeeExponent, &v)) {
+    v = d2d(ieeeMantissa, ieeeExponent);
+  }
+  if (separators->group_char == '\0' || separators->group_size == 0) {
+    return to_chars_fixed(v, ieeeSign, separators->decimal_char, result);
+  }
+  return to_chars_fixed_grouped(v, ieeeSign, separators, result);
+}
+
+int d2s_ecmascript_buffered_n(double f, char* result) {
+  const uint64_t bits = double_to_bits(f);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    // Negative zero is printed as 0.
+    result[0] = '0';
+    return 1;
+  }
+
+  floating_decimal_64 v;
+  // Small integers are less than 10^16, so they are always printed in positional notation.
+  if (!d2d_small_int(ieeeMantissa, ieeeExponent, &v)) {
+    v = d2d(ieeeMantissa, ieeeExponent);
+  }
+
+  // ECMAScript uses positional notation if 1e-6 <= |f| < 1e21, i.e., if the decimal exponent
+  // n = olength + v.exponent satisfies -6 < n <= 21. See Number::toString in the specification.
+  const uint32_t olength = decimalLength17(v.mantissa);
+  const int32_t n = (int32_t) olength + v.exponent;
+  if (-6 < n && n <= 21) {
+    return to_chars_fixed(v, ieeeSign, '.', result);
+  }
+
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  index += to_chars_significand(v.mantissa, olength, result + index);
+  result[index++] = 'e';
+  if (n > 0) {
+    result[index++] = '+';
+  }
+  index += to_chars_exponent(n - 1, result + index);
+  return index;
+}
+
+int d2s_format_buffered_n(double f, const ryu_format* format, char* result) {
+  const uint64_t bits = double_to_bits(f);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_format(result, ieeeSign, ieeeMantissa != 0, format);
+  }
+
+  floating_decimal_64 v;
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    v.mantissa = 0;
+    v.exponent = 0;
+  } else {
+    v = d2d_shortest(ieeeMantissa, ieeeExponent);
+  }
+
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  const uint32_t olength = decimalLength17(v.mantissa);
+  index += to_chars_significand(v.mantissa, olength, result + index);
+  if (olength == 1 && format->trailing_dot_zero) {
+    result[index++] = '.';
+    result[index++] = '0';
+  }
+  result[index++] = format->exponent_char;
+  index += to_chars_exponent_format(v.exponent + (int32_t) olength - 1, format, result + index);
+  return index;
+}
+
+enum ryu_class double_to_fd64(double f, bool* sign, floating_decimal_64* result) {
+  const uint64_t bits = double_to_bits(f);
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  *sign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  result->mantissa = 0;
+  result->exponent = 0;
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return ieeeMantissa != 0 ? RYU_NAN : RYU_INFINITE;
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    return RYU_ZERO;
+  }
+  *result = d2d_shortest(ieeeMantissa, ieeeExponent);
+  return RYU_FINITE;
 }
 
 void d2s_buffered(double f, char* result) {
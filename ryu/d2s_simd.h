@@ -0,0 +1,394 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_D2S_SIMD_H
+#define RYU_D2S_SIMD_H
+
+// Vectorized version of the common case of d2d, used by d2s_batch. This processes 8 doubles at a
+// time with AVX-512, or 4 doubles at a time with AVX2.
+//
+// Neither instruction set has a 64x64->128-bit multiplication, so all wide products are assembled
+// from 32x32->64-bit multiplications (vpmuludq). Rare cases are not handled here: the caller has to
+// use the scalar code for all lanes in the mask returned by d2d_simd.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ryu/common.h"
+
+#if (defined(HAS_AVX512) || defined(HAS_AVX2)) && !defined(RYU_OPTIMIZE_SIZE)
+#define HAS_D2S_SIMD
+
+#include <immintrin.h>
+
+#include "ryu/d2s_full_table.h"
+
+#if defined(HAS_AVX512)
+
+#define D2S_SIMD_LANES 8
+
+typedef __m512i simd_u64;
+typedef __mmask8 simd_mask;
+
+static inline simd_u64 simd_load(const double* const values) {
+  return _mm512_loadu_si512((const void*) values);
+}
+
+static inline void simd_store(uint64_t* const result, const simd_u64 a) {
+  _mm512_storeu_si512((void*) result, a);
+}
+
+static inline simd_u64 simd_set1(const uint64_t x) {
+  return _mm512_set1_epi64((long long) x);
+}
+
+static inline simd_u64 simd_add(const simd_u64 a, const simd_u64 b) {
+  return _mm512_add_epi64(a, b);
+}
+
+static inline simd_u64 simd_sub(const simd_u64 a, const simd_u64 b) {
+  return _mm512_sub_epi64(a, b);
+}
+
+static inline simd_u64 simd_and(const simd_u64 a, const simd_u64 b) {
+  return _mm512_and_si512(a, b);
+}
+
+static inline simd_u64 simd_or(const simd_u64 a, const simd_u64 b) {
+  return _mm512_or_si512(a, b);
+}
+
+static inline simd_u64 simd_srli(const simd_u64 a, const int n) {
+  return _mm512_srl_epi64(a, _mm_cvtsi32_si128(n));
+}
+
+static inline simd_u64 simd_slli(const simd_u64 a, const int n) {
+  return _mm512_sll_epi64(a, _mm_cvtsi32_si128(n));
+}
+
+static inline simd_u64 simd_srlv(const simd_u64 a, const simd_u64 n) {
+  return _mm512_srlv_epi64(a, n);
+}
+
+static inline simd_u64 simd_sllv(const simd_u64 a, const simd_u64 n) {
+  return _mm512_sllv_epi64(a, n);
+}
+
+// Multiplies the low 32 bits of each lane of a and b, producing 64-bit results.
+static inline simd_u64 simd_mul32(const simd_u64 a, const simd_u64 b) {
+  return _mm512_mul_epu32(a, b);
+}
+
+static inline simd_mask simd_eq(const simd_u64 a, const simd_u64 b) {
+  return _mm512_cmpeq_epi64_mask(a, b);
+}
+
+// Unsigned comparison a > b.
+static inline simd_mask simd_gt(const simd_u64 a, const simd_u64 b) {
+  return _mm512_cmpgt_epu64_mask(a, b);
+}
+
+static inline simd_mask simd_mask_and(const simd_mask a, const simd_mask b) {
+  return a & b;
+}
+
+static inline simd_mask simd_mask_or(const simd_mask a, const simd_mask b) {
+  return a | b;
+}
+
+static inline simd_mask simd_mask_andnot(const simd_mask a, const simd_mask b) {
+  return (simd_mask) (~a & b);
+}
+
+static inline uint32_t simd_mask_bits(const simd_mask a) {
+  return a;
+}
+
+// Returns mask ? a : b for each lane.
+static inline simd_u64 simd_select(const simd_mask mask, const simd_u64 a, const simd_u64 b) {
+  return _mm512_mask_blend_epi64(mask, b, a);
+}
+
+// Returns 1 for each lane in mask, and 0 otherwise.
+static inline simd_u64 simd_mask_to_one(const simd_mask mask) {
+  return _mm512_maskz_mov_epi64(mask, simd_set1(1));
+}
+
+// Returns table[index[k]] for each lane k in mask, and src otherwise.
+static inline simd_u64 simd_gather(const simd_u64 src, const simd_mask mask, const simd_u64 index, const uint64_t* const table) {
+  return _mm512_mask_i64gather_epi64(src, mask, index, (const void*) table, 8);
+}
+
+#else // defined(HAS_AVX512)
+
+#define D2S_SIMD_LANES 4
+
+typedef __m256i simd_u64;
+// Each lane is either all zeros or all ones.
+typedef __m256i simd_mask;
+
+static inline simd_u64 simd_load(const double* const values) {
+  return _mm256_loadu_si256((const __m256i*) values);
+}
+
+static inline void simd_store(uint64_t* const result, const simd_u64 a) {
+  _mm256_storeu_si256((__m256i*) result, a);
+}
+
+static inline simd_u64 simd_set1(const uint64_t x) {
+  return _mm256_set1_epi64x((long long) x);
+}
+
+static inline simd_u64 simd_add(const simd_u64 a, const simd_u64 b) {
+  return _mm256_add_epi64(a, b);
+}
+
+static inline simd_u64 simd_sub(const simd_u64 a, const simd_u64 b) {
+  return _mm256_sub_epi64(a, b);
+}
+
+static inline simd_u64 simd_and(const simd_u64 a, const simd_u64 b) {
+  return _mm256_and_si256(a, b);
+}
+
+static inline simd_u64 simd_or(const simd_u64 a, const simd_u64 b) {
+  return _mm256_or_si256(a, b);
+}
+
+static inline simd_u64 simd_srli(const simd_u64 a, const int n) {
+  return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n));
+}
+
+static inline simd_u64 simd_slli(const simd_u64 a, const int n) {
+  return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n));
+}
+
+static inline simd_u64 simd_srlv(const simd_u64 a, const simd_u64 n) {
+  return _mm256_srlv_epi64(a, n);
+}
+
+static inline simd_u64 simd_sllv(const simd_u64 a, const simd_u64 n) {
+  return _mm256_sllv_epi64(a, n);
+}
+
+// Multiplies the low 32 bits of each lane of a and b, producing 64-bit results.
+static inline simd_u64 simd_mul32(const simd_u64 a, const simd_u64 b) {
+  return _mm256_mul_epu32(a, b);
+}
+
+static inline simd_mask simd_eq(const simd_u64 a, const simd_u64 b) {
+  return _mm256_cmpeq_epi64(a, b);
+}
+
+// Unsigned comparison a > b. AVX2 only has a signed comparison, so we flip the sign bits first.
+static inline simd_mask simd_gt(const simd_u64 a, const simd_u64 b) {
+  const simd_u64 sign = simd_set1(1ull << 63);
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+}
+
+static inline simd_mask simd_mask_and(const simd_mask a, const simd_mask b) {
+  return _mm256_and_si256(a, b);
+}
+
+static inline simd_mask simd_mask_or(const simd_mask a, const simd_mask b) {
+  return _mm256_or_si256(a, b);
+}
+
+static inline simd_mask simd_mask_andnot(const simd_mask a, const simd_mask b) {
+  return _mm256_andnot_si256(a, b);
+}
+
+static inline uint32_t simd_mask_bits(const simd_mask a) {
+  return (uint32_t) _mm256_movemask_pd(_mm256_castsi256_pd(a));
+}
+
+// Returns mask ? a : b for each lane.
+static inline simd_u64 simd_select(const simd_mask mask, const simd_u64 a, const simd_u64 b) {
+  return _mm256_blendv_epi8(b, a, mask);
+}
+
+// Returns 1 for each lane in mask, and 0 otherwise.
+static inline simd_u64 simd_mask_to_one(const simd_mask mask) {
+  return _mm256_srli_epi64(mask, 63);
+}
+
+// Returns table[index[k]] for each lane k in mask, and src otherwise.
+static inline simd_u64 simd_gather(const simd_u64 src, const simd_mask mask, const simd_u64 index, const uint64_t* const table) {
+  return _mm256_mask_i64gather_epi64(src, (const long long*) table, index, mask, 8);
+}
+
+#endif // defined(HAS_AVX512)
+
+static inline simd_u64 simd_lo32(const simd_u64 a) {
+  return simd_and(a, simd_set1(0xffffffffu));
+}
+
+// Returns the high 64 bits of the 128-bit product of a and b, where b = bHi * 2^32 + bLo.
+static inline simd_u64 simd_umulh(const simd_u64 a, const simd_u64 bHi, const simd_u64 bLo) {
+  const simd_u64 aHi = simd_srli(a, 32);
+  const simd_u64 b00 = simd_mul32(a, bLo);
+  const simd_u64 b01 = simd_mul32(a, bHi);
+  const simd_u64 b10 = simd_mul32(aHi, bLo);
+  const simd_u64 b11 = simd_mul32(aHi, bHi);
+  // This is less than 3 * 2^32, so it can't overflow.
+  const simd_u64 mid = simd_add(simd_add(simd_srli(b00, 32), simd_lo32(b01)), simd_lo32(b10));
+  return simd_add(simd_add(b11, simd_srli(b01, 32)), simd_add(simd_srli(b10, 32), simd_srli(mid, 32)));
+}
+
+// Same as div10 in d2s_intrinsics.h.
+static inline simd_u64 simd_div10(const simd_u64 x) {
+  return simd_srli(simd_umulh(x, simd_set1(0xCCCCCCCCu), simd_set1(0xCCCCCCCDu)), 3);
+}
+
+// Same as div100 in d2s_intrinsics.h.
+static inline simd_u64 simd_div100(const simd_u64 x) {
+  return simd_srli(simd_umulh(simd_srli(x, 2), simd_set1(0x28F5C28Fu), simd_set1(0x5C28F5C3u)), 2);
+}
+
+// Same as mulShift64 in d2s_intrinsics.h, but the factor is split into four 32-bit pieces
+// mul0 (lowest) to mul3 (highest), and the shift must satisfy 96 < j < 128.
+static inline simd_u64 simd_mulShift64(const simd_u64 m, const simd_u64 mul0, const simd_u64 mul1,
+  const simd_u64 mul2, const simd_u64 mul3, const simd_u64 j) {
+  // m has at most 55 bits, so the product has at most 55 + 124 = 179 bits; we sum up the partial
+  // products in 32-bit columns. None of these sums can overflow 64 bits.
+  const simd_u64 mHi = simd_srli(m, 32);
+  const simd_u64 b00 = simd_mul32(m, mul0);
+  const simd_u64 b01 = simd_mul32(m, mul1);
+  const simd_u64 b02 = simd_mul32(m, mul2);
+  const simd_u64 b03 = simd_mul32(m, mul3);
+  const simd_u64 b10 = simd_mul32(mHi, mul0);
+  const simd_u64 b11 = simd_mul32(mHi, mul1);
+  const simd_u64 b12 = simd_mul32(mHi, mul2);
+  const simd_u64 b13 = simd_mul32(mHi, mul3);
+  const simd_u64 s1 = simd_add(simd_add(simd_srli(b00, 32), simd_lo32(b01)), simd_lo32(b10));
+  const simd_u64 s2 = simd_add(simd_add(simd_add(simd_srli(s1, 32), simd_srli(b01, 32)), simd_add(simd_srli(b10, 32), simd_lo32(b02))), simd_lo32(b11));
+  const simd_u64 s3 = simd_add(simd_add(simd_add(simd_srli(s2, 32), simd_srli(b02, 32)), simd_add(simd_srli(b11, 32), simd_lo32(b03))), simd_lo32(b12));
+  const simd_u64 s4 = simd_add(simd_add(simd_add(simd_srli(s3, 32), simd_srli(b03, 32)), simd_srli(b12, 32)), simd_lo32(b13));
+  const simd_u64 s5 = simd_add(simd_srli(s4, 32), simd_srli(b13, 32));
+  // Bits 96 to 127 of the product are in s3, bits 128 to 159 in s4, and the rest in s5.
+  const simd_u64 dist = simd_sub(j, simd_set1(96));
+  const simd_u64 result = simd_or(simd_srlv(simd_lo32(s3), dist), simd_sllv(simd_lo32(s4), simd_sub(simd_set1(32), dist)));
+  return simd_or(result, simd_sllv(s5, simd_sub(simd_set1(64), dist)));
+}
+
+// Computes d2d for D2S_SIMD_LANES consecutive values. For each lane k, this stores the decimal
+// mantissa and exponent in mantissa[k] and exponent[k].
+//
+// Returns a bit mask of the lanes for which the result is not valid, and that the caller has to
+// convert with the scalar code instead. These are
+// - zero, infinity, and NaN,
+// - all cases in which d2d would use its general case (vmIsTrailingZeros or vrIsTrailingZeros),
+// - e2 >= 0 with q <= 21, where d2d checks for multiples of 5, and
+// - values for which more than three digits can be removed (~1.6% of the common case).
+static inline uint32_t d2d_simd(const double* const values, uint64_t* const mantissa, uint64_t* const exponent) {
+  const simd_u64 one = simd_set1(1);
+  const simd_u64 bits = simd_load(values);
+
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const simd_u64 ieeeMantissa = simd_and(bits, simd_set1((1ull << 52) - 1));
+  const simd_u64 ieeeExponent = simd_and(simd_srli(bits, 52), simd_set1(0x7ff));
+  const simd_mask zeroExponent = simd_eq(ieeeExponent, simd_set1(0));
+  const simd_mask zeroMantissa = simd_eq(ieeeMantissa, simd_set1(0));
+  simd_mask fallback = simd_mask_or(
+    simd_eq(ieeeExponent, simd_set1(0x7ff)), simd_mask_and(zeroExponent, zeroMantissa));
+
+  // e2 + 1077 = max(ieeeExponent, 1); we work with |e2| to avoid signed arithmetic.
+  const simd_u64 biasedE2 = simd_select(zeroExponent, one, ieeeExponent);
+  const simd_u64 m2 = simd_select(zeroExponent, ieeeMantissa, simd_or(ieeeMantissa, simd_set1(1ull << 52)));
+  const simd_mask negative = simd_gt(simd_set1(1077), biasedE2);
+  const simd_u64 absE2 = simd_select(negative, simd_sub(simd_set1(1077), biasedE2), simd_sub(biasedE2, simd_set1(1077)));
+  // mmShift = ieeeMantissa != 0 || ieeeExponent <= 1
+  const simd_u64 mmShift = simd_sub(one, simd_mask_to_one(simd_mask_and(zeroMantissa, simd_gt(ieeeExponent, one))));
+
+  // Step 3: Convert to a decimal power base. See d2d for the details; here we compute both cases
+  // and select the right values.
+  // e2 >= 0: q = log10Pow2(e2) - (e2 > 3), j = -e2 + q + DOUBLE_POW5_INV_BITCOUNT + pow5bits(q) - 1
+  const simd_u64 qp = simd_sub(simd_srli(simd_mul32(absE2, simd_set1(78913)), 18),
+    simd_mask_to_one(simd_gt(absE2, simd_set1(3))));
+  const simd_u64 jp = simd_sub(simd_add(qp, simd_set1(DOUBLE_POW5_INV_BITCOUNT)),
+    simd_sub(absE2, simd_srli(simd_mul32(qp, simd_set1(1217359)), 19)));
+  // e2 < 0: q = log10Pow5(-e2) - (-e2 > 1), i = -e2 - q, j = q - pow5bits(i) + DOUBLE_POW5_BITCOUNT
+  const simd_u64 qm = simd_sub(simd_srli(simd_mul32(absE2, simd_set1(732923)), 20),
+    simd_mask_to_one(simd_gt(absE2, one)));
+  const simd_u64 i = simd_sub(absE2, qm);
+  const simd_u64 jm = simd_sub(simd_add(qm, simd_set1(DOUBLE_POW5_BITCOUNT - 1)),
+    simd_srli(simd_mul32(i, simd_set1(1217359)), 19));
+  const simd_u64 q = simd_select(negative, qm, qp);
+  const simd_u64 j = simd_select(negative, jm, jp);
+  // e10 = q for e2 >= 0, and q + e2 otherwise; we store e10 + 1077 to avoid signed arithmetic.
+  const simd_u64 e10 = simd_select(negative, simd_add(qm, biasedE2), simd_add(qp, simd_set1(1077)));
+
+  // Load the multiplier from DOUBLE_POW5_INV_SPLIT[q] or DOUBLE_POW5_SPLIT[i].
+  const simd_u64 index = simd_slli(simd_select(negative, i, qp), 1);
+  simd_u64 mulLo = simd_gather(simd_set1(0), simd_mask_andnot(negative, simd_eq(one, one)), index, DOUBLE_POW5_INV_SPLIT[0]);
+  mulLo = simd_gather(mulLo, negative, index, DOUBLE_POW5_SPLIT[0]);
+  simd_u64 mulHi = simd_gather(simd_set1(0), simd_mask_andnot(negative, simd_eq(one, one)), simd_add(index, one), DOUBLE_POW5_INV_SPLIT[0]);
+  mulHi = simd_gather(mulHi, negative, simd_add(index, one), DOUBLE_POW5_SPLIT[0]);
+  const simd_u64 mul1 = simd_srli(mulLo, 32);
+  const simd_u64 mul3 = simd_srli(mulHi, 32);
+
+  // Step 2 and 3: Compute vr, vp, and vm for mv = 4 * m2, mp = mv + 2, mm = mv - 1 - mmShift.
+  const simd_u64 mv = simd_slli(m2, 2);
+  simd_u64 vr = simd_mulShift64(mv, mulLo, mul1, mulHi, mul3, j);
+  simd_u64 vp = simd_mulShift64(simd_add(mv, simd_set1(2)), mulLo, mul1, mulHi, mul3, j);
+  simd_u64 vm = simd_mulShift64(simd_sub(simd_sub(mv, one), mmShift), mulLo, mul1, mulHi, mul3, j);
+
+  // e2 >= 0 and q <= 21 requires checking for multiples of 5.
+  fallback = simd_mask_or(fallback, simd_mask_andnot(negative, simd_gt(simd_set1(22), q)));
+  // e2 < 0 and q <= 1 always sets vrIsTrailingZeros. Otherwise, vr is trailing zeros if mv is a
+  // multiple of 2^q. (The q < 63 check in d2d is implied since mv < 2^55.)
+  const simd_u64 pow2Mask = simd_sub(simd_sllv(one, q), one);
+  fallback = simd_mask_or(fallback, simd_mask_and(negative, simd_mask_or(
+    simd_gt(simd_set1(2), q), simd_eq(simd_and(mv, pow2Mask), simd_set1(0)))));
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  // Optimization: remove two digits at a time (~86.2%).
+  const simd_u64 vpDiv100 = simd_div100(vp);
+  const simd_u64 vmDiv100 = simd_div100(vm);
+  const simd_u64 vrDiv100 = simd_div100(vr);
+  const simd_u64 vrMod100 = simd_lo32(simd_sub(vr, simd_mul32(vrDiv100, simd_set1(100))));
+  const simd_mask removeTwo = simd_gt(vpDiv100, vmDiv100);
+  simd_mask roundUp = simd_mask_and(removeTwo, simd_gt(vrMod100, simd_set1(49)));
+  vr = simd_select(removeTwo, vrDiv100, vr);
+  vp = simd_select(removeTwo, vpDiv100, vp);
+  vm = simd_select(removeTwo, vmDiv100, vm);
+  simd_u64 removed = simd_select(removeTwo, simd_set1(2), simd_set1(0));
+
+  // Remove one more digit if possible.
+  const simd_u64 vpDiv10 = simd_div10(vp);
+  const simd_u64 vmDiv10 = simd_div10(vm);
+  const simd_u64 vrDiv10 = simd_div10(vr);
+  const simd_u64 vrMod10 = simd_lo32(simd_sub(vr, simd_mul32(vrDiv10, simd_set1(10))));
+  const simd_mask removeOne = simd_gt(vpDiv10, vmDiv10);
+  roundUp = simd_mask_or(simd_mask_and(removeOne, simd_gt(vrMod10, simd_set1(4))), simd_mask_andnot(removeOne, roundUp));
+  vr = simd_select(removeOne, vrDiv10, vr);
+  vp = simd_select(removeOne, vpDiv10, vp);
+  vm = simd_select(removeOne, vmDiv10, vm);
+  removed = simd_add(removed, simd_mask_to_one(removeOne));
+
+  // Leave the remaining cases to the scalar code.
+  fallback = simd_mask_or(fallback, simd_mask_and(removeOne, simd_gt(simd_div10(vp), simd_div10(vm))));
+
+  // We need to take vr + 1 if vr is outside bounds or we need to round up.
+  const simd_u64 output = simd_add(vr, simd_mask_to_one(simd_mask_or(simd_eq(vr, vm), roundUp)));
+  simd_store(mantissa, output);
+  simd_store(exponent, simd_sub(simd_add(e10, removed), simd_set1(1077)));
+  return simd_mask_bits(fallback);
+}
+
+#endif // (defined(HAS_AVX512) || defined(HAS_AVX2)) && !defined(RYU_OPTIMIZE_SIZE)
+
+#endif // RYU_D2S_SIMD_H
@@ -0,0 +1,85 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_DIGIT_SIMD_H
+#define RYU_DIGIT_SIMD_H
+
+#include <stdint.h>
+
+#include "ryu/common.h"
+
+#if defined(HAS_SSE2)
+
+#include <emmintrin.h>
+#if defined(HAS_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+// Converts abcdefgh and ijklmnop, which must both be less than 10^8, into the 16 characters
+// "abcdefghijklmnop" (including leading zeros).
+//
+// Each 8-digit number is split into two 4-digit numbers, which are then divided by 1000, 100, 10,
+// and 1 in parallel using 16-bit fixed-point multiplications. This is the same technique as in
+// https://github.com/miloyip/itoa-benchmark/blob/master/src/sse2.cpp.
+static inline __m128i digits16(const uint32_t abcdefgh, const uint32_t ijklmnop) {
+  // [abcdefgh, ijklmnop] in the even 32-bit lanes.
+  const __m128i x = _mm_set_epi32(0, (int) ijklmnop, 0, (int) abcdefgh);
+  // abcd = abcdefgh / 10000 and efgh = abcdefgh % 10000, and likewise for the other number.
+  const __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(x, _mm_set1_epi32((int) 0xd1b71759)), 45);
+  const __m128i efgh = _mm_sub_epi32(x, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+  // [abcd, efgh, ijkl, mnop] in 32-bit lanes.
+  const __m128i v1 = _mm_or_si128(abcd, _mm_slli_epi64(efgh, 32));
+  // Each 4-digit number in all four 16-bit lanes of a 64-bit lane, in the order abcd efgh ijkl mnop.
+  // We multiply by 4 to get more precision below.
+  const __m128i v2 = _mm_slli_epi16(_mm_packs_epi32(v1, v1), 2);
+  const __m128i v3 = _mm_unpacklo_epi16(v2, v2);
+  const __m128i v4 = _mm_unpacklo_epi32(v3, v3);
+  const __m128i v5 = _mm_unpackhi_epi32(v3, v3);
+  // [a, ab, abc, abcd, e, ef, efg, efgh] = v / 1000, v / 100, v / 10, v / 1.
+  const __m128i div = _mm_set_epi16(-32768, 13108, 5243, 8389, -32768, 13108, 5243, 8389);
+  const __m128i shift = _mm_set_epi16(-32768, 1 << 13, 1 << 11, 1 << 7, -32768, 1 << 13, 1 << 11, 1 << 7);
+  const __m128i q1 = _mm_mulhi_epu16(_mm_mulhi_epu16(v4, div), shift);
+  const __m128i q2 = _mm_mulhi_epu16(_mm_mulhi_epu16(v5, div), shift);
+  // [a, b, c, d, e, f, g, h] = [a, ab, abc, abcd, ...] - 10 * [0, a, ab, abc, ...].
+  const __m128i ten = _mm_set1_epi16(10);
+  const __m128i d1 = _mm_sub_epi16(q1, _mm_slli_epi64(_mm_mullo_epi16(q1, ten), 16));
+  const __m128i d2 = _mm_sub_epi16(q2, _mm_slli_epi64(_mm_mullo_epi16(q2, ten), 16));
+  return _mm_add_epi8(_mm_packus_epi16(d1, d2), _mm_set1_epi8('0'));
+}
+
+// Stores the characters digits[skip] to digits[15] at result. This writes 16 bytes; the bytes
+// after the last digit are unspecified. Requires skip <= 15.
+static inline void storeDigits16(char* const result, const __m128i digits, const uint32_t skip) {
+#if defined(HAS_SSSE3)
+  // Indices past the end wrap around, which only affects the unspecified bytes.
+  const __m128i indices = _mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  _mm_storeu_si128((__m128i*) result, _mm_shuffle_epi8(digits, _mm_add_epi8(indices, _mm_set1_epi8((char) skip))));
+#else
+  char buffer[32];
+  _mm_storeu_si128((__m128i*) buffer, digits);
+  memcpy(result, buffer + skip, 16);
+#endif
+}
+
+// Stores the characters digits[skip] to digits[7] at result. This writes 8 bytes; the bytes after
+// the last digit are unspecified. Requires skip <= 7.
+static inline void storeDigits8(char* const result, const __m128i digits, const uint32_t skip) {
+  _mm_storel_epi64((__m128i*) result, _mm_srl_epi64(digits, _mm_cvtsi32_si128((int) (8 * skip))));
+}
+
+#endif // defined(HAS_SSE2)
+
+#endif // RYU_DIGIT_SIMD_H
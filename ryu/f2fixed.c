@@ -0,0 +1,488 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// %f and %e formatting for floats. The output is identical to d2fixed and d2exp for the float
+// widened to double, but instead of extracting 9 digits at a time with 192-bit multipliers, we
+// compute all (at most 112) significant digits of the float exactly: a 24-bit mantissa times a
+// power of two or five from f2fixed_full_table.h, in base 10^9 with 64-bit arithmetic.
+//
+// Runtime compiler options:
+// -DRYU_DEBUG Generate verbose debugging output to stdout.
+
+#include "ryu/ryu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <stdio.h>
+#endif
+
+#include "ryu/common.h"
+#include "ryu/digit_table.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/f2fixed_full_table.h"
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BITS 8
+#define FLOAT_BIAS 127
+
+// m2 * 5^149 < 10^112, so 13 blocks of 9 digits.
+#define MAX_BLOCKS 13
+
+// Convert `digits` to a sequence of decimal digits. Append the digits to the result.
+// The caller has to guarantee that:
+//   10^(olength-1) <= digits < 10^olength
+// e.g., by passing `olength` as `decimalLength9(digits)`.
+static inline void append_n_digits(const uint32_t olength, uint32_t digits, char* const result) {
+  uint32_t i = 0;
+  while (digits >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = digits - 10000 * (digits / 10000);
+#else
+    const uint32_t c = digits % 10000;
+#endif
+    digits /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
+    i += 4;
+  }
+  if (digits >= 100) {
+    const uint32_t c = (digits % 100) << 1;
+    digits /= 100;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (digits >= 10) {
+    const uint32_t c = digits << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+  } else {
+    result[0] = (char) ('0' + digits);
+  }
+}
+
+// Convert `digits` to decimal and write the last 9 decimal digits to result.
+// If `digits` contains additional digits, then those are silently ignored.
+static inline void append_nine_digits(uint32_t digits, char* const result) {
+  if (digits == 0) {
+    memset(result, '0', 9);
+    return;
+  }
+
+  for (uint32_t i = 0; i < 5; i += 4) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = digits - 10000 * (digits / 10000);
+#else
+    const uint32_t c = digits % 10000;
+#endif
+    digits /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + 7 - i, DIGIT_TABLE + c0, 2);
+    memcpy(result + 5 - i, DIGIT_TABLE + c1, 2);
+  }
+  result[0] = (char) ('0' + digits);
+}
+
+// m2 * 2^e2 * 10^max(-e2, 0) is an integer, and we compute it as m * pow, where m < 2^31 and pow is a
+// power of two or five from f2fixed_full_table.h in base 10^9, least significant block first. Stores
+// m and pow, and returns the number of blocks of pow. m2 must be less than 2^24.
+static inline uint32_t float_power(const uint32_t m2, const int32_t e2, uint64_t* const m, const uint32_t** const pow) {
+  if (e2 >= 0) {
+    // m2 * 2^e2 = (m2 * 2^(e2 % 8)) * 2^(8q)
+    const uint32_t q = (uint32_t) e2 / 8;
+    *m = (uint64_t) m2 << (e2 % 8);
+    *pow = F2FIXED_POW2 + F2FIXED_POW2_OFFSET[q];
+    return F2FIXED_POW2_OFFSET[q + 1] - F2FIXED_POW2_OFFSET[q];
+  }
+  // m2 * 5^-e2 = (m2 * 5^(-e2 % 4)) * 5^(4q)
+  static const uint32_t SMALL_POW5[4] = { 1, 5, 25, 125 };
+  const uint32_t q = (uint32_t) -e2 / 4;
+  *m = (uint64_t) m2 * SMALL_POW5[(uint32_t) -e2 % 4];
+  *pow = F2FIXED_POW5 + F2FIXED_POW5_OFFSET[q];
+  return F2FIXED_POW5_OFFSET[q + 1] - F2FIXED_POW5_OFFSET[q];
+}
+
+// Computes the blocks of m * pow from index `first` upwards, and returns the total number of blocks.
+// The most significant block is nonzero. Blocks below first may or may not be computed; first may
+// exceed length, in which case all blocks are computed.
+static inline uint32_t multiply_blocks(const uint64_t m, const uint32_t* const pow, uint32_t length,
+  const uint32_t first, uint32_t* const blocks) {
+  // Each block of pow is less than 10^9 < 2^30, so the products fit into 64 bits. The carry into
+  // each block is less than m.
+  uint64_t carry = 0;
+  uint32_t i = 0;
+  // Block length - 1 must be computed, as it is the most significant block if there is no carry.
+  if (first >= 2 && first < length) {
+    // The carry into block first - 1 is in [low, low + 3], as the carry into block first - 2 is less
+    // than m < 3 * 10^9. Unless the carry into block first depends on which, we can skip the lower
+    // blocks.
+    const uint64_t low = div1e9(m * pow[first - 2]);
+    const uint64_t product = m * pow[first - 1];
+    const uint64_t minCarry = div1e9(product + low);
+    if (minCarry == div1e9(product + low + 3)) {
+      carry = minCarry;
+      i = first;
+    }
+  }
+  // We split each product into two blocks independently of the others, and only propagate a carry
+  // of at most 3 from block to block, so that the divisions don't depend on each other.
+  for (; i < length; ++i) {
+    const uint64_t product = m * pow[i];
+    const uint64_t high = div1e9(product);
+    const uint64_t sum = (product - 1000000000 * high) + carry;
+    const uint32_t overflow = (uint32_t) (sum / 1000000000);
+    blocks[i] = (uint32_t) sum - 1000000000 * overflow;
+    carry = high + overflow;
+  }
+  // The last block of each power is nonzero, so the most significant block is nonzero unless we
+  // append a nonzero carry.
+  while (carry != 0) {
+    blocks[length++] = mod1e9(carry);
+    carry = div1e9(carry);
+  }
+  return length;
+}
+
+// Returns the number of decimal digits of the given blocks.
+static inline uint32_t blocks_length(const uint32_t* const blocks, const uint32_t count) {
+  return decimalLength9(blocks[count - 1]) + 9 * (count - 1);
+}
+
+// Writes the decimal digits of the given blocks without leading zeros to digits, most significant
+// first, and returns the number of written digits. Only writes the blocks that contain the first
+// `needed` digits.
+static inline uint32_t blocks_to_digits(const uint32_t* const blocks, const uint32_t count, const uint32_t needed,
+  char* const digits) {
+  const uint32_t olength = decimalLength9(blocks[count - 1]);
+  append_n_digits(olength, blocks[count - 1], digits);
+  uint32_t index = olength;
+  for (uint32_t i = count - 1; i > 0 && index < needed; --i) {
+    append_nine_digits(blocks[i - 1], digits + index);
+    index += 9;
+  }
+#ifdef RYU_DEBUG
+  printf("digits=%.*s\n", (int) index, digits);
+#endif
+  return index;
+}
+
+// Returns true if m2 * 2^e2 * 10^max(-e2, 0) is divisible by 10^k, i.e., if its last k digits are 0.
+static inline bool multipleOfPowerOf10(const uint32_t m2, const int32_t e2, const uint32_t k) {
+  const uint32_t twos = e2 >= 0 ? (uint32_t) e2 : 0;
+  const uint32_t fives = e2 >= 0 ? 0 : (uint32_t) -e2;
+  // m2 < 2^24 can't be a multiple of 2^32.
+  return (k <= twos || (k - twos < 32 && multipleOfPowerOf2(m2, k - twos)))
+    && (k <= fives || multipleOfPowerOf5(m2, k - fives));
+}
+
+// Returns 0 if the digits from index onwards are less than half a unit in the previous digit, 1 if
+// they are more, and 2 if they are exactly half, i.e., if the result should be rounded to even.
+// digits holds the first `written` of the `length` digits of m2 * 2^e2 * 10^max(-e2, 0). If
+// index < written does not hold, all digits from index onwards must be zero.
+static inline int round_up_from(const char* const digits, const uint32_t written, const uint32_t length,
+  const uint32_t m2, const int32_t e2, const uint32_t index) {
+  if (index >= written || digits[index] < '5') {
+    return 0;
+  }
+  if (digits[index] > '5') {
+    return 1;
+  }
+  for (uint32_t i = index + 1; i < written; ++i) {
+    if (digits[i] != '0') {
+      return 1;
+    }
+  }
+  return multipleOfPowerOf10(m2, e2, length - written) ? 2 : 1;
+}
+
+static inline int copy_special_str_printf(char* const result, const bool sign, const uint32_t mantissa) {
+#if defined(_MSC_VER)
+  if (sign) {
+    result[0] = '-';
+  }
+  if (mantissa) {
+    // Widening to double quiets signaling NaNs, so d2fixed never prints nan(snan) for a float.
+    memcpy(result + sign, "nan", 3);
+    return sign + 3;
+  }
+#else
+  if (mantissa) {
+    memcpy(result, "nan", 3);
+    return 3;
+  }
+  if (sign) {
+    result[0] = '-';
+  }
+#endif
+  memcpy(result + sign, "Infinity", 8);
+  return sign + 8;
+}
+
+int f2fixed_buffered_n(float f, uint32_t precision, char* result) {
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_printf(result, ieeeSign, ieeeMantissa);
+  }
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  // The value is less than 2^(e2 + 24). If that is at most 10^(-precision - 1), all printed digits
+  // are zero and we don't round up.
+  if (m2 == 0 || (e2 + 24 < 0 && log10Pow2(-(e2 + 24)) > precision)) {
+    result[index++] = '0';
+    if (precision > 0) {
+      result[index++] = '.';
+      memset(result + index, '0', precision);
+      index += precision;
+    }
+    return index;
+  }
+
+  // The value is digits * 10^-fractionLength, so the first integerLength digits are before the
+  // decimal dot. integerLength is negative if there are leading zeros after the decimal dot. We
+  // need the digits up to firstRemoved, the first digit that isn't printed, which is the
+  // lowestNeeded-th digit from the right.
+  const int32_t fractionLength = e2 < 0 ? -e2 : 0;
+  const int64_t lowestNeeded = fractionLength - (int64_t) precision - 1;
+  uint64_t m;
+  const uint32_t* pow;
+  const uint32_t powLength = float_power(m2, e2, &m, &pow);
+  uint32_t blocks[MAX_BLOCKS];
+  const uint32_t first = lowestNeeded > 0 ? (uint32_t) (lowestNeeded / 9) : 0;
+  const uint32_t count = multiply_blocks(m, pow, powLength, first, blocks);
+  const uint32_t length = blocks_length(blocks, count);
+  const int32_t integerLength = (int32_t) length - fractionLength;
+  const int64_t firstRemoved = integerLength + (int64_t) precision;
+  char digits[9 * MAX_BLOCKS];
+  const uint32_t needed = firstRemoved < 0 ? 0 : (uint32_t) firstRemoved + 1;
+  const uint32_t written = blocks_to_digits(blocks, count, needed, digits);
+
+  if (integerLength > 0) {
+    memcpy(result + index, digits, (uint32_t) integerLength);
+    index += integerLength;
+  } else {
+    result[index++] = '0';
+  }
+  int roundUp = 0;
+  if (precision > 0) {
+    result[index++] = '.';
+    // Leading zeros after the decimal dot, then the fractional digits, then trailing zeros.
+    const uint32_t zeros = integerLength >= 0 ? 0
+      : (uint32_t) -integerLength < precision ? (uint32_t) -integerLength : precision;
+    memset(result + index, '0', zeros);
+    index += zeros;
+    const uint32_t start = integerLength > 0 ? (uint32_t) integerLength : 0;
+    const uint32_t available = written - start;
+    const uint32_t copied = precision - zeros < available ? precision - zeros : available;
+    memcpy(result + index, digits + start, copied);
+    index += copied;
+    memset(result + index, '0', precision - zeros - copied);
+    index += precision - zeros - copied;
+  }
+  // If firstRemoved is negative, the value is less than 10^(-precision - 1) and rounds to zero.
+  if (firstRemoved >= 0) {
+    roundUp = round_up_from(digits, written, length, m2, e2, (uint32_t) firstRemoved);
+  }
+#ifdef RYU_DEBUG
+  printf("roundUp=%d\n", roundUp);
+#endif
+  if (roundUp != 0) {
+    int roundIndex = index;
+    int dotIndex = 0; // '.' can't be located at index 0
+    while (true) {
+      --roundIndex;
+      char c;
+      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+        result[roundIndex + 1] = '1';
+        if (dotIndex > 0) {
+          result[dotIndex] = '0';
+          result[dotIndex + 1] = '.';
+        }
+        result[index++] = '0';
+        break;
+      }
+      if (c == '.') {
+        dotIndex = roundIndex;
+        continue;
+      } else if (c == '9') {
+        result[roundIndex] = '0';
+        roundUp = 1;
+        continue;
+      } else {
+        if (roundUp == 2 && c % 2 == 0) {
+          break;
+        }
+        result[roundIndex] = c + 1;
+        break;
+      }
+    }
+  }
+  return index;
+}
+
+void f2fixed_buffered(float f, uint32_t precision, char* result) {
+  const int len = f2fixed_buffered_n(f, precision, result);
+  result[len] = '\0';
+}
+
+char* f2fixed(float f, uint32_t precision) {
+  // Sign, 39 integer digits plus one for rounding up, decimal dot, and null terminator.
+  char* const buffer = (char*)malloc(43 + precision);
+  const int index = f2fixed_buffered_n(f, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
+
+int f2exp_buffered_n(float f, uint32_t precision, char* result) {
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_printf(result, ieeeSign, ieeeMantissa);
+  }
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    result[index++] = '0';
+    if (precision > 0) {
+      result[index++] = '.';
+      memset(result + index, '0', precision);
+      index += precision;
+    }
+    memcpy(result + index, "e+00", 4);
+    index += 4;
+    return index;
+  }
+
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+  // We need the first precision + 2 digits, including the first removed digit. There is at least
+  // one digit in block powLength - 1 and above.
+  uint64_t m;
+  const uint32_t* pow;
+  const uint32_t powLength = float_power(m2, e2, &m, &pow);
+  const uint32_t neededBlocks = (precision + 2 + 7) / 9;
+  uint32_t blocks[MAX_BLOCKS];
+  const uint32_t first = powLength > neededBlocks + 1 ? powLength - 1 - neededBlocks : 0;
+  const uint32_t count = multiply_blocks(m, pow, powLength, first, blocks);
+  const uint32_t length = blocks_length(blocks, count);
+  char digits[9 * MAX_BLOCKS];
+  const uint32_t written = blocks_to_digits(blocks, count, precision + 2, digits);
+  int32_t exp = (int32_t) length - 1 + (e2 < 0 ? e2 : 0);
+
+  // Print precision + 1 significant digits, padded with zeros if the value has fewer digits.
+  const uint32_t copied = precision + 1 < written ? precision + 1 : written;
+  result[index++] = digits[0];
+  if (precision > 0) {
+    result[index++] = '.';
+    memcpy(result + index, digits + 1, copied - 1);
+    index += copied - 1;
+    memset(result + index, '0', precision + 1 - copied);
+    index += precision + 1 - copied;
+  }
+  int roundUp = round_up_from(digits, written, length, m2, e2, precision + 1);
+#ifdef RYU_DEBUG
+  printf("roundUp=%d\n", roundUp);
+#endif
+  if (roundUp != 0) {
+    int roundIndex = index;
+    while (true) {
+      --roundIndex;
+      char c;
+      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+        result[roundIndex + 1] = '1';
+        ++exp;
+        break;
+      }
+      if (c == '.') {
+        continue;
+      } else if (c == '9') {
+        result[roundIndex] = '0';
+        roundUp = 1;
+        continue;
+      } else {
+        if (roundUp == 2 && c % 2 == 0) {
+          break;
+        }
+        result[roundIndex] = c + 1;
+        break;
+      }
+    }
+  }
+  result[index++] = 'e';
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else {
+    result[index++] = '+';
+  }
+  // Float exponents are in [-45, 38], so there are always two digits.
+  memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+  index += 2;
+  return index;
+}
+
+void f2exp_buffered(float f, uint32_t precision, char* result) {
+  const int len = f2exp_buffered_n(f, precision, result);
+  result[len] = '\0';
+}
+
+char* f2exp(float f, uint32_t precision) {
+  // Sign, first digit, decimal dot, exponent, and null terminator; "-Infinity" needs 10 bytes.
+  char* const buffer = (char*)malloc(8 + (precision < 2 ? 2 : precision));
+  const int index = f2exp_buffered_n(f, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
@@ -0,0 +1,99 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_F2FIXED_FULL_TABLE_H
+#define RYU_F2FIXED_FULL_TABLE_H
+
+#include <stdint.h>
+
+// Tables for f2fixed.c. A float m2 * 2^e2 is the integer m2 * 2^e2 if e2 >= 0, and the integer
+// m2 * 5^-e2 divided by 10^-e2 otherwise, so its exact decimal digits are those of an integer of at
+// most 39 or 112 digits. The tables hold the powers of two and five in base 10^9, least significant
+// block first; row q starts at OFFSET[q] and ends at OFFSET[q + 1].
+
+// 2^(8q) for q in [0, 13]; the largest float exponent is 104 = 8 * 13.
+static const uint16_t F2FIXED_POW2_OFFSET[15] = {
+  0, 1, 2, 3, 4, 6, 8, 10, 12, 15,
+  18, 21, 24, 28, 32
+};
+
+static const uint32_t F2FIXED_POW2[32] = {
+          1u,
+        256u,
+      65536u,
+   16777216u,
+  294967296u,         4u,
+  511627776u,      1099u,
+  976710656u,    281474u,
+   37927936u,  72057594u,
+  709551616u, 446744073u,        18u,
+  645213696u, 366482869u,      4722u,
+  174706176u, 819614629u,   1208925u,
+  724781056u, 821345068u, 309485009u,
+  543950336u, 264337593u, 228162514u,        79u,
+  251286016u, 670423947u, 409603651u,     20282u
+};
+
+// 5^(4q) for q in [0, 37]; the smallest float exponent is -149 = -(4 * 37 + 1).
+static const uint16_t F2FIXED_POW5_OFFSET[39] = {
+  0, 1, 2, 3, 4, 6, 8, 10, 13, 16,
+  19, 23, 27, 31, 36, 41, 46, 51, 57, 63,
+  69, 76, 83, 90, 98, 106, 114, 123, 132, 141,
+  151, 161, 171, 181, 192, 203, 214, 226, 238
+};
+
+static const uint32_t F2FIXED_POW5[238] = {
+          1u,
+        625u,
+     390625u,
+  244140625u,
+  587890625u,       152u,
+  431640625u,     95367u,
+  775390625u,  59604644u,
+  619140625u, 252902984u,        37u,
+  962890625u,  64365386u,     23283u,
+  806640625u, 228366851u,  14551915u,
+  150390625u, 729282379u,  94947017u,         9u,
+  994140625u, 801486968u, 341886080u,      5684u,
+  337890625u, 929355621u, 678800500u,   3552713u,
+  181640625u, 847263336u, 250313080u, 220446049u,         2u,
+  525390625u, 539585113u, 445675529u, 778780781u,      1387u,
+  369140625u, 240695953u, 547205962u, 737988403u,    867361u,
+  712890625u, 434970855u,   3726400u, 242752217u, 542101086u,
+  556640625u, 856784820u, 329000271u, 720135627u, 813178901u,       338u,
+  900390625u, 490512847u, 625169910u,  84767080u, 236813575u,    211758u,
+  744140625u, 570529937u, 731194056u, 979425390u,   8484427u, 132348898u,
+   87890625u, 581211090u, 996285356u, 140869206u, 302767487u, 718061255u,        82u,
+  931640625u, 256931304u, 678347863u,  43254372u, 229679463u, 788284564u,     51698u,
+  275390625u, 582065582u, 967414535u,  33982923u, 549664402u, 677852643u,  32311742u,
+  119140625u, 790988922u, 634084738u, 239327479u, 540251271u, 657902218u, 194839173u,        20u,
+  462890625u, 368076324u, 302961744u, 579674771u, 657044524u, 188886587u, 774483536u,     12621u,
+  306640625u,  47702789u, 351090230u, 296732064u, 652827862u,  54117285u,  52210118u,   7888609u,
+  650390625u, 814243316u, 431393779u, 457540219u,  17413935u, 823303533u, 631323783u, 930380657u,         4u,
+  494140625u, 902072906u, 621112383u, 962637144u, 883709660u, 564708135u, 577364889u, 487911019u,      3081u,
+  837890625u, 795566558u, 195239938u, 648215388u, 318538101u, 942584927u, 853055977u, 944387235u,   1925929u,
+  681640625u, 229099273u,  24961747u, 134617622u,  86313530u, 115579574u, 159986214u, 242022408u, 203706215u,         1u,
+   25390625u, 187046051u, 601092018u, 136013765u, 945956334u, 237233803u, 991383822u, 264005099u, 316384526u,       752u,
+  869140625u, 903781890u, 682511366u,   8603500u, 222708835u, 271127466u, 614888898u,   3187494u, 740328915u,    470197u,
+  212890625u, 863681793u, 569604314u, 377187926u, 193021880u, 454666389u, 305561419u, 992184134u, 705571876u, 293873587u,
+   56640625u, 801120758u,   2696789u, 742454106u, 638675235u, 166493245u, 975887159u, 115083940u, 982423120u, 670992315u,       183u,
+  400390625u, 700473785u, 685493625u,  33816251u, 172022339u,  58278524u, 929474479u, 927463109u,  14450071u, 370197489u,    114794u,
+  244140625u, 796115875u, 433516062u, 135157303u, 513961896u, 424077607u, 921549411u, 664443705u,  31294954u, 373430634u,  71746481u,
+  587890625u, 572422027u, 947539247u, 473314645u, 226185084u,  48504696u, 968382140u, 277316200u, 559346665u, 394146269u, 841550858u,        44u,
+  431640625u, 763767242u, 212029732u, 821653717u, 365677795u, 315435141u, 238837530u, 322625605u, 591665798u, 341418474u, 969286496u,     28025u
+};
+
+#endif // RYU_F2FIXED_FULL_TABLE_H
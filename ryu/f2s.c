@@ -17,6 +17,10 @@
 
 // Runtime compiler options:
 // -DRYU_DEBUG Generate verbose debugging output to stdout.
+//
+// -DRYU_NO_SIMD Don't use the SSE2/SSSE3 code path in to_chars or the AVX2 or
+//     AVX-512 code path in f2s_batch, even if the compiler targets these
+//     instruction sets (e.g., with -march=native).
 
 #include "ryu/ryu.h"
 
@@ -34,19 +38,13 @@
 #include "ryu/common.h"
 #include "ryu/f2s_intrinsics.h"
 #include "ryu/digit_table.h"
+#include "ryu/digit_simd.h"
+#include "ryu/f2s_simd.h"
 
 #define FLOAT_MANTISSA_BITS 23
 #define FLOAT_EXPONENT_BITS 8
 #define FLOAT_BIAS 127
 
-// A floating decimal representing m * 10^e.
-typedef struct floating_decimal_32 {
-  uint32_t mantissa;
-  // Decimal exponent's range is -45 to 38
-  // inclusive, and can fit in a short if needed.
-  int32_t exponent;
-} floating_decimal_32;
-
 static inline floating_decimal_32 f2d(const uint32_t ieeeMantissa, const uint32_t ieeeExponent) {
   int32_t e2;
   uint32_t m2;
@@ -227,22 +225,9 @@ static inline floating_decimal_32 f2d(const uint32_t ieeeMantissa, const uint32_
   return fd;
 }
 
-static inline int to_chars(const floating_decimal_32 v, const bool sign, char* const result) {
-  // Step 5: Print the decimal representation.
+// Prints the olength digits of output, with a decimal dot after the first digit if olength > 1.
+static inline int to_chars_significand(uint32_t output, const uint32_t olength, char* const result) {
   int index = 0;
-  if (sign) {
-    result[index++] = '-';
-  }
-
-  uint32_t output = v.mantissa;
-  const uint32_t olength = decimalLength9(output);
-
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", v.mantissa);
-  printf("OLEN=%u\n", olength);
-  printf("EXP=%u\n", v.exponent + olength);
-#endif
-
   // Print the decimal digits.
   // The following code is equivalent to:
   // for (uint32_t i = 0; i < olength - 1; ++i) {
@@ -250,6 +235,22 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   //   result[index + olength - i] = (char) ('0' + c);
   // }
   // result[index] = '0' + output % 10;
+#if defined(HAS_SSE2)
+  // Convert all 9 digit positions at once, and then move the olength significant digits into
+  // place. This writes up to 8 bytes past the first digit; anything after the last digit is
+  // overwritten by the exponent, or is past the end of the string.
+  const uint32_t first = output / 100000000;
+  const __m128i digits = digits16(output - 100000000 * first, 0);
+  if (olength == 9) {
+    result[index] = (char) ('0' + first);
+    storeDigits8(result + index + 2, digits, 0);
+  } else {
+    // Write the first digit to result[index + 1] and move it to the front; the decimal dot goes
+    // where it was.
+    storeDigits8(result + index + 1, digits, 8 - olength);
+    result[index] = result[index + 1];
+  }
+#else
   uint32_t i = 0;
   while (output >= 10000) {
 #ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
@@ -278,6 +279,7 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   } else {
     result[index] = (char) ('0' + output);
   }
+#endif
 
   // Print decimal point if needed.
   if (olength > 1) {
@@ -286,10 +288,12 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   } else {
     ++index;
   }
+  return index;
+}
 
-  // Print the exponent.
-  result[index++] = 'E';
-  int32_t exp = v.exponent + (int32_t) olength - 1;
+// Prints exp, preceded by a minus sign if it is negative.
+static inline int to_chars_exponent(int32_t exp, char* const result) {
+  int index = 0;
   if (exp < 0) {
     result[index++] = '-';
     exp = -exp;
@@ -301,10 +305,127 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   } else {
     result[index++] = (char) ('0' + exp);
   }
+  return index;
+}
+
+// Prints exp with at least format->min_exponent_digits digits, preceded by a minus sign if it is
+// negative, or by a plus sign if it is not and format->exponent_sign is set.
+static inline int to_chars_exponent_format(int32_t exp, const ryu_format* const format, char* const result) {
+  int index = 0;
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else if (format->exponent_sign) {
+    result[index++] = '+';
+  }
+  const uint32_t elength = exp >= 10 ? 2 : 1;
+  for (uint32_t i = elength; i < format->min_exponent_digits; ++i) {
+    result[index++] = '0';
+  }
+  return index + to_chars_exponent(exp, result + index);
+}
+
+static inline int copy_special_str_format(char* const result, const bool sign, const bool nan,
+  const ryu_format* const format) {
+  if (nan) {
+    const size_t length = strlen(format->nan);
+    memcpy(result, format->nan, length);
+    return (int) length;
+  }
+  if (sign) {
+    result[0] = '-';
+  }
+  const size_t length = strlen(format->infinity);
+  memcpy(result + sign, format->infinity, length);
+  return sign + (int) length;
+}
+
+static inline int to_chars(const floating_decimal_32 v, const bool sign, char* const result) {
+  // Step 5: Print the decimal representation.
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  const uint32_t output = v.mantissa;
+  const uint32_t olength = decimalLength9(output);
+
+#ifdef RYU_DEBUG
+  printf("DIGITS=%u\n", v.mantissa);
+  printf("OLEN=%u\n", olength);
+  printf("EXP=%u\n", v.exponent + olength);
+#endif
+
+  index += to_chars_significand(output, olength, result + index);
 
+  // Print the exponent.
+  result[index++] = 'E';
+  index += to_chars_exponent(v.exponent + (int32_t) olength - 1, result + index);
   return index;
 }
 
+// Writes the olength decimal digits of output to result.
+static inline void writeDigits9(uint32_t output, const uint32_t olength, char* const result) {
+  uint32_t i = 0;
+  while (output >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = output - 10000 * (output / 10000);
+#else
+    const uint32_t c = output % 10000;
+#endif
+    output /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
+    i += 4;
+  }
+  if (output >= 100) {
+    const uint32_t c = (output % 100) << 1;
+    output /= 100;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (output >= 10) {
+    memcpy(result, DIGIT_TABLE + 2 * output, 2);
+  } else {
+    result[0] = (char) ('0' + output);
+  }
+}
+
+// Prints v in positional notation, e.g., 123.45, 1200, or 0.0012.
+static inline int to_chars_fixed(const floating_decimal_32 v, const bool sign, char* const result) {
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  const uint32_t output = v.mantissa;
+  const int32_t olength = (int32_t) decimalLength9(output);
+  // The number of digits before the decimal dot, if positive.
+  const int32_t intLength = olength + v.exponent;
+
+  if (v.exponent >= 0) {
+    // All digits are before the decimal dot, followed by v.exponent zeros.
+    writeDigits9(output, (uint32_t) olength, result + index);
+    memset(result + index + olength, '0', (size_t) v.exponent);
+    return index + intLength;
+  }
+  if (intLength > 0) {
+    // Print the digits one position to the right, and then move the integer part into place.
+    writeDigits9(output, (uint32_t) olength, result + index + 1);
+    memmove(result + index, result + index + 1, (size_t) intLength);
+    result[index + intLength] = '.';
+    return index + olength + 1;
+  }
+  // All digits are after the decimal dot, preceded by -intLength zeros.
+  result[index] = '0';
+  result[index + 1] = '.';
+  memset(result + index + 2, '0', (size_t) -intLength);
+  writeDigits9(output, (uint32_t) olength, result + index + 2 - intLength);
+  return index + 2 - intLength + olength;
+}
+
 int f2s_buffered_n(float f, char* result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint32_t bits = float_to_bits(f);
@@ -331,6 +452,106 @@ int f2s_buffered_n(float f, char* result) {
   return to_chars(v, ieeeSign, result);
 }
 
+int f2s_batch(const float* values, int count, char* result, int* offsets) {
+  int index = 0;
+  int i = 0;
+#if defined(HAS_F2S_SIMD)
+  // Run f2d on F2S_SIMD_LANES values at a time, and only use the scalar code for the lanes that the
+  // vector code can't handle.
+  for (; i + F2S_SIMD_LANES <= count; i += F2S_SIMD_LANES) {
+    uint64_t mantissa[F2S_SIMD_LANES];
+    uint64_t exponent[F2S_SIMD_LANES];
+    const uint32_t fallback = f2d_simd(values + i, mantissa, exponent);
+    for (int k = 0; k < F2S_SIMD_LANES; ++k) {
+      offsets[i + k] = index;
+      if ((fallback >> k) & 1) {
+        index += f2s_buffered_n(values[i + k], result + index);
+      } else {
+        floating_decimal_32 v;
+        v.mantissa = (uint32_t) mantissa[k];
+        v.exponent = (int32_t) exponent[k];
+        index += to_chars(v, (float_to_bits(values[i + k]) >> 31) != 0, result + index);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    offsets[i] = index;
+    index += f2s_buffered_n(values[i], result + index);
+  }
+  offsets[count] = index;
+  return index;
+}
+
+int f2s_fixed_shortest_buffered_n(float f, char* result) {
+  const uint32_t bits = float_to_bits(f);
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    if (ieeeSign) {
+      result[0] = '-';
+    }
+    result[ieeeSign] = '0';
+    return ieeeSign + 1;
+  }
+
+  const floating_decimal_32 v = f2d(ieeeMantissa, ieeeExponent);
+  return to_chars_fixed(v, ieeeSign, result);
+}
+
+int f2s_format_buffered_n(float f, const ryu_format* format, char* result) {
+  const uint32_t bits = float_to_bits(f);
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_format(result, ieeeSign, ieeeMantissa != 0, format);
+  }
+
+  floating_decimal_32 v;
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    v.mantissa = 0;
+    v.exponent = 0;
+  } else {
+    v = f2d(ieeeMantissa, ieeeExponent);
+  }
+
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  const uint32_t olength = decimalLength9(v.mantissa);
+  index += to_chars_significand(v.mantissa, olength, result + index);
+  if (olength == 1 && format->trailing_dot_zero) {
+    result[index++] = '.';
+    result[index++] = '0';
+  }
+  result[index++] = format->exponent_char;
+  index += to_chars_exponent_format(v.exponent + (int32_t) olength - 1, format, result + index);
+  return index;
+}
+
+enum ryu_class float_to_fd32(float f, bool* sign, floating_decimal_32* result) {
+  const uint32_t bits = float_to_bits(f);
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+  *sign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  result->mantissa = 0;
+  result->exponent = 0;
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return ieeeMantissa != 0 ? RYU_NAN : RYU_INFINITE;
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    return RYU_ZERO;
+  }
+  *result = f2d(ieeeMantissa, ieeeExponent);
+  return RYU_FINITE;
+}
+
 void f2s_buffered(float f, char* result) {
   const int index = f2s_buffered_n(f, result);
 
@@ -0,0 +1,173 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_F2S_SIMD_H
+#define RYU_F2S_SIMD_H
+
+// Vectorized version of the common case of f2d, used by f2s_batch. This uses the 64-bit lane
+// helpers from d2s_simd.h, since mulShift32 needs 32x64-bit products: it processes 8 floats at a
+// time with AVX-512, or 4 floats at a time with AVX2. As in d2s_simd.h, the caller has to use the
+// scalar code for all lanes in the mask returned by f2d_simd.
+
+#include <stdint.h>
+
+#include "ryu/d2s_simd.h"
+
+// The vector code reads the multipliers from the double tables (see f2s_intrinsics.h), so we don't
+// use it with RYU_FLOAT_FULL_TABLE.
+#if defined(HAS_D2S_SIMD) && !defined(RYU_FLOAT_FULL_TABLE)
+#define HAS_F2S_SIMD
+
+#define F2S_SIMD_LANES D2S_SIMD_LANES
+
+// Loads F2S_SIMD_LANES floats and zero-extends their bits to 64-bit lanes.
+static inline simd_u64 simd_load_float(const float* const values) {
+#if defined(HAS_AVX512)
+  return _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*) values));
+#else
+  return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*) values));
+#endif
+}
+
+// Same as div10 for 32-bit values.
+static inline simd_u64 simd_div10_32(const simd_u64 x) {
+  return simd_srli(simd_mul32(x, simd_set1(0xCCCCCCCDu)), 35);
+}
+
+// Same as mulShift32 in f2s_intrinsics.h; factor is split into the 32-bit halves factorLo and
+// factorHi, and shift must be greater than 32.
+static inline simd_u64 simd_mulShift32(const simd_u64 m, const simd_u64 factorLo, const simd_u64 factorHi,
+  const simd_u64 shift) {
+  const simd_u64 sum = simd_add(simd_srli(simd_mul32(m, factorLo), 32), simd_mul32(m, factorHi));
+  return simd_srlv(sum, simd_sub(shift, simd_set1(32)));
+}
+
+// Computes f2d for F2S_SIMD_LANES consecutive values. For each lane k, this stores the decimal
+// mantissa and exponent in mantissa[k] and exponent[k].
+//
+// Returns a bit mask of the lanes for which the result is not valid, and that the caller has to
+// convert with the scalar code instead. These are
+// - zero, infinity, and NaN,
+// - e2 >= 0 with q <= 9, where f2d checks for multiples of 5, and
+// - all other cases in which f2d would use its general case (vrIsTrailingZeros).
+static inline uint32_t f2d_simd(const float* const values, uint64_t* const mantissa, uint64_t* const exponent) {
+  const simd_u64 one = simd_set1(1);
+  const simd_u64 bits = simd_load_float(values);
+
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const simd_u64 ieeeMantissa = simd_and(bits, simd_set1((1u << 23) - 1));
+  const simd_u64 ieeeExponent = simd_and(simd_srli(bits, 23), simd_set1(0xff));
+  const simd_mask zeroExponent = simd_eq(ieeeExponent, simd_set1(0));
+  const simd_mask zeroMantissa = simd_eq(ieeeMantissa, simd_set1(0));
+  simd_mask fallback = simd_mask_or(
+    simd_eq(ieeeExponent, simd_set1(0xff)), simd_mask_and(zeroExponent, zeroMantissa));
+
+  // e2 + 152 = max(ieeeExponent, 1); we work with |e2| to avoid signed arithmetic.
+  const simd_u64 biasedE2 = simd_select(zeroExponent, one, ieeeExponent);
+  const simd_u64 m2 = simd_select(zeroExponent, ieeeMantissa, simd_or(ieeeMantissa, simd_set1(1u << 23)));
+  const simd_mask negative = simd_gt(simd_set1(152), biasedE2);
+  const simd_u64 absE2 = simd_select(negative, simd_sub(simd_set1(152), biasedE2), simd_sub(biasedE2, simd_set1(152)));
+  // mmShift = ieeeMantissa != 0 || ieeeExponent <= 1
+  const simd_u64 mmShift = simd_sub(one, simd_mask_to_one(simd_mask_and(zeroMantissa, simd_gt(ieeeExponent, one))));
+
+  // Step 3: Convert to a decimal power base. See f2d for the details; here we compute both cases
+  // and select the right values. We also need the multiplier and shift for q - 1 (or i + 1) to
+  // compute the last removed digit in case the loop below doesn't remove any digits.
+  // e2 >= 0: q = log10Pow2(e2), j = -e2 + q + FLOAT_POW5_INV_BITCOUNT + pow5bits(q) - 1
+  const simd_u64 qp = simd_srli(simd_mul32(absE2, simd_set1(78913)), 18);
+  // q == 0 only happens in fallback lanes; this keeps the table index in bounds.
+  const simd_u64 qp1 = simd_sub(simd_add(qp, simd_mask_to_one(simd_eq(qp, simd_set1(0)))), one);
+  const simd_u64 jp = simd_sub(simd_add(qp, simd_set1(FLOAT_POW5_INV_BITCOUNT)),
+    simd_sub(absE2, simd_srli(simd_mul32(qp, simd_set1(1217359)), 19)));
+  const simd_u64 jp1 = simd_sub(simd_add(qp1, simd_set1(FLOAT_POW5_INV_BITCOUNT)),
+    simd_sub(absE2, simd_srli(simd_mul32(qp1, simd_set1(1217359)), 19)));
+  // e2 < 0: q = log10Pow5(-e2), i = -e2 - q, j = q - pow5bits(i) + FLOAT_POW5_BITCOUNT
+  const simd_u64 qm = simd_srli(simd_mul32(absE2, simd_set1(732923)), 20);
+  const simd_u64 i = simd_sub(absE2, qm);
+  const simd_u64 jm = simd_sub(simd_add(qm, simd_set1(FLOAT_POW5_BITCOUNT - 1)),
+    simd_srli(simd_mul32(i, simd_set1(1217359)), 19));
+  const simd_u64 jm1 = simd_sub(simd_add(qm, simd_set1(FLOAT_POW5_BITCOUNT - 2)),
+    simd_srli(simd_mul32(simd_add(i, one), simd_set1(1217359)), 19));
+  const simd_u64 q = simd_select(negative, qm, qp);
+  const simd_u64 j = simd_select(negative, jm, jp);
+  const simd_u64 j1 = simd_select(negative, jm1, jp1);
+  // e10 = q for e2 >= 0, and q + e2 otherwise; we store e10 + 152 to avoid signed arithmetic.
+  const simd_u64 e10 = simd_select(negative, simd_add(qm, biasedE2), simd_add(qp, simd_set1(152)));
+
+  // Find the lanes that f2d handles in its general case.
+  const simd_mask positive = simd_mask_andnot(negative, simd_eq(one, one));
+  const simd_u64 mv = simd_slli(m2, 2);
+  // e2 >= 0 and q <= 9 requires checking for multiples of 5.
+  fallback = simd_mask_or(fallback, simd_mask_and(positive, simd_gt(simd_set1(10), q)));
+  // e2 < 0 and q <= 1 always sets vrIsTrailingZeros. Otherwise, if q < 31, vr is trailing zeros if
+  // mv is a multiple of 2^(q - 1).
+  const simd_u64 pow2Mask = simd_sub(simd_sllv(one, simd_sub(q, one)), one);
+  fallback = simd_mask_or(fallback, simd_mask_and(negative, simd_mask_or(simd_gt(simd_set1(2), q),
+    simd_mask_and(simd_gt(simd_set1(31), q), simd_eq(simd_and(mv, pow2Mask), simd_set1(0))))));
+  // Inputs with few significant digits, e.g., small integers, often hit the cases above in all
+  // lanes, so we skip the rest in that case.
+  if (simd_mask_bits(fallback) == (1u << F2S_SIMD_LANES) - 1) {
+    return simd_mask_bits(fallback);
+  }
+
+  // Load the multipliers from the upper halves of DOUBLE_POW5_INV_SPLIT[q] + 1 or
+  // DOUBLE_POW5_SPLIT[i], and likewise for q - 1 and i + 1.
+  const simd_u64 index = simd_add(simd_slli(simd_select(negative, i, qp), 1), one);
+  const simd_u64 index1 = simd_add(simd_slli(simd_select(negative, simd_add(i, one), qp1), 1), one);
+  simd_u64 mul = simd_gather(simd_set1(0), positive, index, DOUBLE_POW5_INV_SPLIT[0]);
+  mul = simd_gather(simd_add(mul, simd_mask_to_one(positive)), negative, index, DOUBLE_POW5_SPLIT[0]);
+  simd_u64 mul1 = simd_gather(simd_set1(0), positive, index1, DOUBLE_POW5_INV_SPLIT[0]);
+  mul1 = simd_gather(simd_add(mul1, simd_mask_to_one(positive)), negative, index1, DOUBLE_POW5_SPLIT[0]);
+  const simd_u64 mulHi = simd_srli(mul, 32);
+  const simd_u64 mul1Hi = simd_srli(mul1, 32);
+
+  // Step 2 and 3: Compute vr, vp, and vm for mv = 4 * m2, mp = mv + 2, mm = mv - 1 - mmShift.
+  simd_u64 vr = simd_mulShift32(mv, mul, mulHi, j);
+  simd_u64 vp = simd_mulShift32(simd_add(mv, simd_set1(2)), mul, mulHi, j);
+  simd_u64 vm = simd_mulShift32(simd_sub(simd_sub(mv, one), mmShift), mul, mulHi, j);
+  const simd_u64 vr1 = simd_mulShift32(mv, mul1, mul1Hi, j1);
+  simd_u64 lastRemovedDigit = simd_sub(vr1, simd_mul32(simd_div10_32(vr1), simd_set1(10)));
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  // Loop iterations in f2d: 0: 13.6%, 1: 70.7%, 2: 14.1%, 3: 1.39%, 4: 0.14%, 5+: 0.01%
+  // Short outputs such as 2.5E-1 need many more, so we iterate until no lane can remove another
+  // digit. Fallback lanes may contain garbage, so we exclude them.
+  simd_u64 removed = simd_set1(0);
+  simd_u64 vpDiv10 = simd_div10_32(vp);
+  simd_u64 vmDiv10 = simd_div10_32(vm);
+  simd_mask removeOne = simd_mask_andnot(fallback, simd_gt(vpDiv10, vmDiv10));
+  while (simd_mask_bits(removeOne) != 0) {
+    const simd_u64 vrDiv10 = simd_div10_32(vr);
+    lastRemovedDigit = simd_select(removeOne, simd_sub(vr, simd_mul32(vrDiv10, simd_set1(10))), lastRemovedDigit);
+    vr = simd_select(removeOne, vrDiv10, vr);
+    vp = simd_select(removeOne, vpDiv10, vp);
+    vm = simd_select(removeOne, vmDiv10, vm);
+    removed = simd_add(removed, simd_mask_to_one(removeOne));
+    vpDiv10 = simd_div10_32(vp);
+    vmDiv10 = simd_div10_32(vm);
+    removeOne = simd_mask_andnot(fallback, simd_gt(vpDiv10, vmDiv10));
+  }
+
+  // We need to take vr + 1 if vr is outside bounds or we need to round up.
+  const simd_u64 output = simd_add(vr, simd_mask_to_one(simd_mask_or(simd_eq(vr, vm), simd_gt(lastRemovedDigit, simd_set1(4)))));
+  simd_store(mantissa, output);
+  simd_store(exponent, simd_sub(simd_add(e10, removed), simd_set1(152)));
+  return simd_mask_bits(fallback);
+}
+
+#endif // defined(HAS_D2S_SIMD) && !defined(RYU_FLOAT_FULL_TABLE)
+
+#endif // RYU_F2S_SIMD_H
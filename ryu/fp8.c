@@ -0,0 +1,96 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Shortest conversion for the 8-bit formats E4M3 and E5M2. There are only 256 values each, so
+// instead of running Ryu, we copy the precomputed strings from fp8_table.h.
+//
+// Runtime compiler options:
+// -DRYU_NO_SIMD Don't use the SSE2 and AVX2 code paths, even if the compiler targets these
+//     instruction sets.
+
+#include "ryu/ryu.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ryu/common.h"
+#include "ryu/fp8_table.h"
+
+#if defined(HAS_AVX2)
+#include <immintrin.h>
+#elif defined(HAS_SSE2)
+#include <emmintrin.h>
+#endif
+
+// Copies the 16-byte entry, including the padding after the string.
+static inline int copy_entry(const fp8_string* const entry, char* const result) {
+#if defined(HAS_SSE2)
+  _mm_storeu_si128((__m128i*) result, _mm_loadu_si128((const __m128i*) entry));
+#else
+  memcpy(result, entry, sizeof(fp8_string));
+#endif
+  return entry->length;
+}
+
+static inline int fp8_batch(const fp8_string* const table, const uint8_t* const values, const int count,
+  char* const result, int* const offsets) {
+  int index = 0;
+  int i = 0;
+  offsets[0] = 0;
+#if defined(HAS_AVX2)
+  // Gather the lengths of 8 values from the last byte of their entries, and compute the end offsets
+  // with a prefix sum. Only the copies remain in the loop.
+  const __m256i lengthIndex = _mm256_set1_epi32(3);
+  for (; i + 8 <= count; i += 8) {
+    const __m256i codes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (values + i)));
+    __m256i ends = _mm256_srli_epi32(
+      _mm256_i32gather_epi32((const int*) table, _mm256_add_epi32(_mm256_slli_epi32(codes, 2), lengthIndex), 4), 24);
+    // Prefix sums within each 128-bit half, then add the total of the lower half to the upper half.
+    ends = _mm256_add_epi32(ends, _mm256_slli_si256(ends, 4));
+    ends = _mm256_add_epi32(ends, _mm256_slli_si256(ends, 8));
+    const __m256i lowerTotal = _mm256_permutevar8x32_epi32(ends, lengthIndex);
+    ends = _mm256_add_epi32(ends, _mm256_blend_epi32(_mm256_setzero_si256(), lowerTotal, 0xf0));
+    ends = _mm256_add_epi32(ends, _mm256_set1_epi32(index));
+    _mm256_storeu_si256((__m256i*) (offsets + i + 1), ends);
+    for (int k = 0; k < 8; ++k) {
+      copy_entry(&table[values[i + k]], result + offsets[i + k]);
+    }
+    index = offsets[i + 8];
+  }
+#endif
+  for (; i < count; ++i) {
+    index += copy_entry(&table[values[i]], result + index);
+    offsets[i + 1] = index;
+  }
+  return index;
+}
+
+int fp8_e4m3_buffered_n(uint8_t bits, char* result) {
+  return copy_entry(&FP8_E4M3_TABLE[bits], result);
+}
+
+int fp8_e5m2_buffered_n(uint8_t bits, char* result) {
+  return copy_entry(&FP8_E5M2_TABLE[bits], result);
+}
+
+int fp8_e4m3_batch(const uint8_t* values, int count, char* result, int* offsets) {
+  return fp8_batch(FP8_E4M3_TABLE, values, count, result, offsets);
+}
+
+int fp8_e5m2_batch(const uint8_t* values, int count, char* result, int* offsets) {
+  return fp8_batch(FP8_E5M2_TABLE, values, count, result, offsets);
+}
@@ -0,0 +1,170 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_FP8_TABLE_H
+#define RYU_FP8_TABLE_H
+
+#include <stdint.h>
+
+// The shortest representations of all 256 values of the 8-bit formats E4M3 and E5M2, indexed by
+// bit pattern. These are the strings that generic_binary_to_decimal and generic_to_chars in
+// generic_128.c produce; fp8_test checks every entry.
+//
+// E4M3 has no infinities, and only S.1111.111 is NaN, so the values with exponent field 1111 are
+// normal numbers up to 448. E5M2 follows the IEEE conventions.
+//
+// Each entry is 16 bytes, so it can be copied with a single vector load and store. The length is
+// in the last byte, where fp8.c can also gather it with 32-bit loads.
+typedef struct fp8_string {
+  char str[15];
+  uint8_t length;
+} fp8_string;
+
+static const fp8_string FP8_E4M3_TABLE[256] = {
+  { "0E0", 3 }, { "2E-3", 4 }, { "4E-3", 4 }, { "6E-3", 4 },
+  { "8E-3", 4 }, { "1E-2", 4 }, { "1.2E-2", 6 }, { "1.4E-2", 6 },
+  { "1.6E-2", 6 }, { "1.8E-2", 6 }, { "2E-2", 4 }, { "2.1E-2", 6 },
+  { "2.3E-2", 6 }, { "2.5E-2", 6 }, { "2.7E-2", 6 }, { "3E-2", 4 },
+  { "3.1E-2", 6 }, { "3.5E-2", 6 }, { "4E-2", 4 }, { "4.3E-2", 6 },
+  { "4.7E-2", 6 }, { "5E-2", 4 }, { "5.5E-2", 6 }, { "6E-2", 4 },
+  { "6.2E-2", 6 }, { "7E-2", 4 }, { "8E-2", 4 }, { "8.6E-2", 6 },
+  { "9E-2", 4 }, { "1E-1", 4 }, { "1.1E-1", 6 }, { "1.2E-1", 6 },
+  { "1.3E-1", 6 }, { "1.4E-1", 6 }, { "1.6E-1", 6 }, { "1.7E-1", 6 },
+  { "1.9E-1", 6 }, { "2E-1", 4 }, { "2.2E-1", 6 }, { "2.3E-1", 6 },
+  { "2.5E-1", 6 }, { "2.8E-1", 6 }, { "3E-1", 4 }, { "3.4E-1", 6 },
+  { "3.8E-1", 6 }, { "4E-1", 4 }, { "4.4E-1", 6 }, { "4.7E-1", 6 },
+  { "5E-1", 4 }, { "5.6E-1", 6 }, { "6E-1", 4 }, { "7E-1", 4 },
+  { "7.5E-1", 6 }, { "8E-1", 4 }, { "9E-1", 4 }, { "9.4E-1", 6 },
+  { "1E0", 3 }, { "1.1E0", 5 }, { "1.2E0", 5 }, { "1.4E0", 5 },
+  { "1.5E0", 5 }, { "1.6E0", 5 }, { "1.8E0", 5 }, { "1.9E0", 5 },
+  { "2E0", 3 }, { "2.2E0", 5 }, { "2.5E0", 5 }, { "2.8E0", 5 },
+  { "3E0", 3 }, { "3.2E0", 5 }, { "3.5E0", 5 }, { "3.8E0", 5 },
+  { "4E0", 3 }, { "4.5E0", 5 }, { "5E0", 3 }, { "5.5E0", 5 },
+  { "6E0", 3 }, { "6.5E0", 5 }, { "7E0", 3 }, { "7.5E0", 5 },
+  { "8E0", 3 }, { "9E0", 3 }, { "1E1", 3 }, { "1.1E1", 5 },
+  { "1.2E1", 5 }, { "1.3E1", 5 }, { "1.4E1", 5 }, { "1.5E1", 5 },
+  { "1.6E1", 5 }, { "1.8E1", 5 }, { "2E1", 3 }, { "2.2E1", 5 },
+  { "2.4E1", 5 }, { "2.6E1", 5 }, { "2.8E1", 5 }, { "3E1", 3 },
+  { "3.2E1", 5 }, { "3.6E1", 5 }, { "4E1", 3 }, { "4.4E1", 5 },
+  { "5E1", 3 }, { "5.2E1", 5 }, { "5.6E1", 5 }, { "6E1", 3 },
+  { "6.4E1", 5 }, { "7E1", 3 }, { "8E1", 3 }, { "9E1", 3 },
+  { "1E2", 3 }, { "1.04E2", 6 }, { "1.1E2", 5 }, { "1.2E2", 5 },
+  { "1.3E2", 5 }, { "1.4E2", 5 }, { "1.6E2", 5 }, { "1.8E2", 5 },
+  { "2E2", 3 }, { "2.1E2", 5 }, { "2.2E2", 5 }, { "2.4E2", 5 },
+  { "2.6E2", 5 }, { "3E2", 3 }, { "3.2E2", 5 }, { "3.5E2", 5 },
+  { "4E2", 3 }, { "4.2E2", 5 }, { "4.5E2", 5 }, { "NaN", 3 },
+  { "-0E0", 4 }, { "-2E-3", 5 }, { "-4E-3", 5 }, { "-6E-3", 5 },
+  { "-8E-3", 5 }, { "-1E-2", 5 }, { "-1.2E-2", 7 }, { "-1.4E-2", 7 },
+  { "-1.6E-2", 7 }, { "-1.8E-2", 7 }, { "-2E-2", 5 }, { "-2.1E-2", 7 },
+  { "-2.3E-2", 7 }, { "-2.5E-2", 7 }, { "-2.7E-2", 7 }, { "-3E-2", 5 },
+  { "-3.1E-2", 7 }, { "-3.5E-2", 7 }, { "-4E-2", 5 }, { "-4.3E-2", 7 },
+  { "-4.7E-2", 7 }, { "-5E-2", 5 }, { "-5.5E-2", 7 }, { "-6E-2", 5 },
+  { "-6.2E-2", 7 }, { "-7E-2", 5 }, { "-8E-2", 5 }, { "-8.6E-2", 7 },
+  { "-9E-2", 5 }, { "-1E-1", 5 }, { "-1.1E-1", 7 }, { "-1.2E-1", 7 },
+  { "-1.3E-1", 7 }, { "-1.4E-1", 7 }, { "-1.6E-1", 7 }, { "-1.7E-1", 7 },
+  { "-1.9E-1", 7 }, { "-2E-1", 5 }, { "-2.2E-1", 7 }, { "-2.3E-1", 7 },
+  { "-2.5E-1", 7 }, { "-2.8E-1", 7 }, { "-3E-1", 5 }, { "-3.4E-1", 7 },
+  { "-3.8E-1", 7 }, { "-4E-1", 5 }, { "-4.4E-1", 7 }, { "-4.7E-1", 7 },
+  { "-5E-1", 5 }, { "-5.6E-1", 7 }, { "-6E-1", 5 }, { "-7E-1", 5 },
+  { "-7.5E-1", 7 }, { "-8E-1", 5 }, { "-9E-1", 5 }, { "-9.4E-1", 7 },
+  { "-1E0", 4 }, { "-1.1E0", 6 }, { "-1.2E0", 6 }, { "-1.4E0", 6 },
+  { "-1.5E0", 6 }, { "-1.6E0", 6 }, { "-1.8E0", 6 }, { "-1.9E0", 6 },
+  { "-2E0", 4 }, { "-2.2E0", 6 }, { "-2.5E0", 6 }, { "-2.8E0", 6 },
+  { "-3E0", 4 }, { "-3.2E0", 6 }, { "-3.5E0", 6 }, { "-3.8E0", 6 },
+  { "-4E0", 4 }, { "-4.5E0", 6 }, { "-5E0", 4 }, { "-5.5E0", 6 },
+  { "-6E0", 4 }, { "-6.5E0", 6 }, { "-7E0", 4 }, { "-7.5E0", 6 },
+  { "-8E0", 4 }, { "-9E0", 4 }, { "-1E1", 4 }, { "-1.1E1", 6 },
+  { "-1.2E1", 6 }, { "-1.3E1", 6 }, { "-1.4E1", 6 }, { "-1.5E1", 6 },
+  { "-1.6E1", 6 }, { "-1.8E1", 6 }, { "-2E1", 4 }, { "-2.2E1", 6 },
+  { "-2.4E1", 6 }, { "-2.6E1", 6 }, { "-2.8E1", 6 }, { "-3E1", 4 },
+  { "-3.2E1", 6 }, { "-3.6E1", 6 }, { "-4E1", 4 }, { "-4.4E1", 6 },
+  { "-5E1", 4 }, { "-5.2E1", 6 }, { "-5.6E1", 6 }, { "-6E1", 4 },
+  { "-6.4E1", 6 }, { "-7E1", 4 }, { "-8E1", 4 }, { "-9E1", 4 },
+  { "-1E2", 4 }, { "-1.04E2", 7 }, { "-1.1E2", 6 }, { "-1.2E2", 6 },
+  { "-1.3E2", 6 }, { "-1.4E2", 6 }, { "-1.6E2", 6 }, { "-1.8E2", 6 },
+  { "-2E2", 4 }, { "-2.1E2", 6 }, { "-2.2E2", 6 }, { "-2.4E2", 6 },
+  { "-2.6E2", 6 }, { "-3E2", 4 }, { "-3.2E2", 6 }, { "-3.5E2", 6 },
+  { "-4E2", 4 }, { "-4.2E2", 6 }, { "-4.5E2", 6 }, { "NaN", 3 }
+};
+
+static const fp8_string FP8_E5M2_TABLE[256] = {
+  { "0E0", 3 }, { "2E-5", 4 }, { "3E-5", 4 }, { "5E-5", 4 },
+  { "6E-5", 4 }, { "8E-5", 4 }, { "9E-5", 4 }, { "1E-4", 4 },
+  { "1.2E-4", 6 }, { "1.5E-4", 6 }, { "1.8E-4", 6 }, { "2E-4", 4 },
+  { "2.4E-4", 6 }, { "3E-4", 4 }, { "3.7E-4", 6 }, { "4E-4", 4 },
+  { "5E-4", 4 }, { "6E-4", 4 }, { "7E-4", 4 }, { "9E-4", 4 },
+  { "1E-3", 4 }, { "1.2E-3", 6 }, { "1.5E-3", 6 }, { "1.7E-3", 6 },
+  { "2E-3", 4 }, { "2.4E-3", 6 }, { "3E-3", 4 }, { "3.4E-3", 6 },
+  { "4E-3", 4 }, { "5E-3", 4 }, { "6E-3", 4 }, { "7E-3", 4 },
+  { "8E-3", 4 }, { "1E-2", 4 }, { "1.2E-2", 6 }, { "1.4E-2", 6 },
+  { "1.6E-2", 6 }, { "2E-2", 4 }, { "2.3E-2", 6 }, { "2.7E-2", 6 },
+  { "3E-2", 4 }, { "4E-2", 4 }, { "5E-2", 4 }, { "5.5E-2", 6 },
+  { "6E-2", 4 }, { "8E-2", 4 }, { "1E-1", 4 }, { "1.1E-1", 6 },
+  { "1.2E-1", 6 }, { "1.6E-1", 6 }, { "2E-1", 4 }, { "2.2E-1", 6 },
+  { "2.5E-1", 6 }, { "3E-1", 4 }, { "4E-1", 4 }, { "4.4E-1", 6 },
+  { "5E-1", 4 }, { "6E-1", 4 }, { "8E-1", 4 }, { "9E-1", 4 },
+  { "1E0", 3 }, { "1.2E0", 5 }, { "1.5E0", 5 }, { "1.8E0", 5 },
+  { "2E0", 3 }, { "2.5E0", 5 }, { "3E0", 3 }, { "3.5E0", 5 },
+  { "4E0", 3 }, { "5E0", 3 }, { "6E0", 3 }, { "7E0", 3 },
+  { "8E0", 3 }, { "1E1", 3 }, { "1.2E1", 5 }, { "1.4E1", 5 },
+  { "1.6E1", 5 }, { "2E1", 3 }, { "2.4E1", 5 }, { "2.8E1", 5 },
+  { "3E1", 3 }, { "4E1", 3 }, { "5E1", 3 }, { "5.6E1", 5 },
+  { "6E1", 3 }, { "8E1", 3 }, { "1E2", 3 }, { "1.1E2", 5 },
+  { "1.3E2", 5 }, { "1.6E2", 5 }, { "2E2", 3 }, { "2.2E2", 5 },
+  { "2.6E2", 5 }, { "3E2", 3 }, { "4E2", 3 }, { "4.5E2", 5 },
+  { "5E2", 3 }, { "6E2", 3 }, { "8E2", 3 }, { "9E2", 3 },
+  { "1E3", 3 }, { "1.3E3", 5 }, { "1.5E3", 5 }, { "1.8E3", 5 },
+  { "2E3", 3 }, { "2.6E3", 5 }, { "3E3", 3 }, { "3.6E3", 5 },
+  { "4E3", 3 }, { "5E3", 3 }, { "6E3", 3 }, { "7E3", 3 },
+  { "8E3", 3 }, { "1E4", 3 }, { "1.2E4", 5 }, { "1.4E4", 5 },
+  { "1.6E4", 5 }, { "2E4", 3 }, { "2.5E4", 5 }, { "3E4", 3 },
+  { "3.3E4", 5 }, { "4E4", 3 }, { "5E4", 3 }, { "6E4", 3 },
+  { "Infinity", 8 }, { "NaN", 3 }, { "NaN", 3 }, { "NaN", 3 },
+  { "-0E0", 4 }, { "-2E-5", 5 }, { "-3E-5", 5 }, { "-5E-5", 5 },
+  { "-6E-5", 5 }, { "-8E-5", 5 }, { "-9E-5", 5 }, { "-1E-4", 5 },
+  { "-1.2E-4", 7 }, { "-1.5E-4", 7 }, { "-1.8E-4", 7 }, { "-2E-4", 5 },
+  { "-2.4E-4", 7 }, { "-3E-4", 5 }, { "-3.7E-4", 7 }, { "-4E-4", 5 },
+  { "-5E-4", 5 }, { "-6E-4", 5 }, { "-7E-4", 5 }, { "-9E-4", 5 },
+  { "-1E-3", 5 }, { "-1.2E-3", 7 }, { "-1.5E-3", 7 }, { "-1.7E-3", 7 },
+  { "-2E-3", 5 }, { "-2.4E-3", 7 }, { "-3E-3", 5 }, { "-3.4E-3", 7 },
+  { "-4E-3", 5 }, { "-5E-3", 5 }, { "-6E-3", 5 }, { "-7E-3", 5 },
+  { "-8E-3", 5 }, { "-1E-2", 5 }, { "-1.2E-2", 7 }, { "-1.4E-2", 7 },
+  { "-1.6E-2", 7 }, { "-2E-2", 5 }, { "-2.3E-2", 7 }, { "-2.7E-2", 7 },
+  { "-3E-2", 5 }, { "-4E-2", 5 }, { "-5E-2", 5 }, { "-5.5E-2", 7 },
+  { "-6E-2", 5 }, { "-8E-2", 5 }, { "-1E-1", 5 }, { "-1.1E-1", 7 },
+  { "-1.2E-1", 7 }, { "-1.6E-1", 7 }, { "-2E-1", 5 }, { "-2.2E-1", 7 },
+  { "-2.5E-1", 7 }, { "-3E-1", 5 }, { "-4E-1", 5 }, { "-4.4E-1", 7 },
+  { "-5E-1", 5 }, { "-6E-1", 5 }, { "-8E-1", 5 }, { "-9E-1", 5 },
+  { "-1E0", 4 }, { "-1.2E0", 6 }, { "-1.5E0", 6 }, { "-1.8E0", 6 },
+  { "-2E0", 4 }, { "-2.5E0", 6 }, { "-3E0", 4 }, { "-3.5E0", 6 },
+  { "-4E0", 4 }, { "-5E0", 4 }, { "-6E0", 4 }, { "-7E0", 4 },
+  { "-8E0", 4 }, { "-1E1", 4 }, { "-1.2E1", 6 }, { "-1.4E1", 6 },
+  { "-1.6E1", 6 }, { "-2E1", 4 }, { "-2.4E1", 6 }, { "-2.8E1", 6 },
+  { "-3E1", 4 }, { "-4E1", 4 }, { "-5E1", 4 }, { "-5.6E1", 6 },
+  { "-6E1", 4 }, { "-8E1", 4 }, { "-1E2", 4 }, { "-1.1E2", 6 },
+  { "-1.3E2", 6 }, { "-1.6E2", 6 }, { "-2E2", 4 }, { "-2.2E2", 6 },
+  { "-2.6E2", 6 }, { "-3E2", 4 }, { "-4E2", 4 }, { "-4.5E2", 6 },
+  { "-5E2", 4 }, { "-6E2", 4 }, { "-8E2", 4 }, { "-9E2", 4 },
+  { "-1E3", 4 }, { "-1.3E3", 6 }, { "-1.5E3", 6 }, { "-1.8E3", 6 },
+  { "-2E3", 4 }, { "-2.6E3", 6 }, { "-3E3", 4 }, { "-3.6E3", 6 },
+  { "-4E3", 4 }, { "-5E3", 4 }, { "-6E3", 4 }, { "-7E3", 4 },
+  { "-8E3", 4 }, { "-1E4", 4 }, { "-1.2E4", 6 }, { "-1.4E4", 6 },
+  { "-1.6E4", 6 }, { "-2E4", 4 }, { "-2.5E4", 6 }, { "-3E4", 4 },
+  { "-3.3E4", 6 }, { "-4E4", 4 }, { "-5E4", 4 }, { "-6E4", 4 },
+  { "-Infinity", 9 }, { "NaN", 3 }, { "NaN", 3 }, { "NaN", 3 }
+};
+
+#endif // RYU_FP8_TABLE_H
@@ -169,7 +169,7 @@ struct floating_decimal_128 generic_binary_to_decimal(
     if (q <= 55) {
       // Only one of mp, mv, and mm can be a multiple of 5, if any.
       if (mv % 5 == 0) {
-        vrIsTrailingZeros = multipleOfPowerOf5(mv, q - 1);
+        vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
       } else if (acceptBounds) {
         // Same as min(e2 + (~mm & 1), pow5Factor(mm)) >= q
         // <=> e2 + (~mm & 1) >= q && pow5Factor(mm) >= q
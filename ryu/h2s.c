@@ -0,0 +1,397 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Shortest round-trip conversion for the 16-bit formats IEEE binary16 (half) and bfloat16. This is
+// the same algorithm as f2s, but with a mantissa of at most 11 bits, 32-bit multipliers are
+// sufficient, so every multiplication is a single 32x32->64-bit product.
+//
+// Runtime compiler options:
+// -DRYU_DEBUG Generate verbose debugging output to stdout.
+
+#include "ryu/ryu.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <stdio.h>
+#endif
+
+#include "ryu/common.h"
+#include "ryu/digit_table.h"
+
+#define HALF_MANTISSA_BITS 10
+#define HALF_EXPONENT_BITS 5
+#define HALF_BIAS 15
+
+#define BFLOAT16_MANTISSA_BITS 7
+#define BFLOAT16_EXPONENT_BITS 8
+#define BFLOAT16_BIAS 127
+
+// These tables are defined like FLOAT_POW5_INV_SPLIT and FLOAT_POW5_SPLIT in f2s_full_table.h,
+// but with 31 and 32 bits, respectively. bfloat16 has the same exponent range as float, which
+// requires q <= 35 and i <= 42; half only uses the entries for q = 0 and i <= 9. We've verified
+// exhaustively that these are precise enough for all 2^16 values of both formats.
+#define F16_POW5_INV_BITCOUNT 31
+#define F16_POW5_BITCOUNT 32
+
+static const uint32_t F16_POW5_INV_SPLIT[36] = {
+  2147483649u, 1717986919u, 1374389535u, 1099511628u, 1759218605u, 1407374884u,
+  1125899907u, 1801439851u, 1441151881u, 1152921505u, 1844674408u, 1475739526u,
+  1180591621u, 1888946594u, 1511157275u, 1208925820u, 1934281312u, 1547425050u,
+  1237940040u, 1980704063u, 1584563251u, 1267650601u, 2028240961u, 1622592769u,
+  1298074215u, 2076918744u, 1661534995u, 1329227996u, 2126764794u, 1701411835u,
+  1361129468u, 1088903575u, 1742245719u, 1393796575u, 1115037260u, 1784059616u
+};
+
+static const uint32_t F16_POW5_SPLIT[43] = {
+  2147483648u, 2684354560u, 3355443200u, 4194304000u, 2621440000u, 3276800000u,
+  4096000000u, 2560000000u, 3200000000u, 4000000000u, 2500000000u, 3125000000u,
+  3906250000u, 2441406250u, 3051757812u, 3814697265u, 2384185791u, 2980232238u,
+  3725290298u, 2328306436u, 2910383045u, 3637978807u, 2273736754u, 2842170943u,
+  3552713678u, 2220446049u, 2775557561u, 3469446951u, 2168404344u, 2710505431u,
+  3388131789u, 4235164736u, 2646977960u, 3308722450u, 4135903062u, 2584939414u,
+  3231174267u, 4038967834u, 2524354896u, 3155443620u, 3944304526u, 2465190328u,
+  3081487911u
+};
+
+static inline uint32_t mulShift16(const uint32_t m, const uint32_t factor, const int32_t shift) {
+  assert(shift > 0 && shift < 64);
+  return (uint32_t) (((uint64_t) m * factor) >> shift);
+}
+
+static inline uint32_t mulPow5InvDivPow2(const uint32_t m, const uint32_t q, const int32_t j) {
+  return mulShift16(m, F16_POW5_INV_SPLIT[q], j);
+}
+
+static inline uint32_t mulPow5divPow2(const uint32_t m, const uint32_t i, const int32_t j) {
+  return mulShift16(m, F16_POW5_SPLIT[i], j);
+}
+
+// Returns true if value is divisible by 5^p.
+static inline bool multipleOfPowerOf5_16(uint32_t value, const uint32_t p) {
+  for (uint32_t count = 0; count < p; ++count) {
+    if (value % 5 != 0) {
+      return false;
+    }
+    value /= 5;
+  }
+  return true;
+}
+
+// Returns true if value is divisible by 2^p.
+static inline bool multipleOfPowerOf2_16(const uint32_t value, const uint32_t p) {
+  return (value & ((1u << p) - 1)) == 0;
+}
+
+// Same as f2d in f2s.c for a binary format with the given number of mantissa bits and bias.
+static inline floating_decimal_32 h2d(const uint32_t ieeeMantissa, const uint32_t ieeeExponent,
+  const uint32_t mantissaBits, const int32_t bias) {
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    // We subtract 2 so that the bounds computation has 2 additional bits.
+    e2 = 1 - bias - (int32_t) mantissaBits - 2;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - bias - (int32_t) mantissaBits - 2;
+    m2 = (1u << mantissaBits) | ieeeMantissa;
+  }
+  const bool even = (m2 & 1) == 0;
+  const bool acceptBounds = even;
+
+#ifdef RYU_DEBUG
+  printf("-> %u * 2^%d\n", m2, e2 + 2);
+#endif
+
+  // Step 2: Determine the interval of valid decimal representations.
+  const uint32_t mv = 4 * m2;
+  const uint32_t mp = 4 * m2 + 2;
+  // Implicit bool -> int conversion. True is 1, false is 0.
+  const uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+  const uint32_t mm = 4 * m2 - 1 - mmShift;
+
+  // Step 3: Convert to a decimal power base using 64-bit arithmetic.
+  uint32_t vr, vp, vm;
+  int32_t e10;
+  bool vmIsTrailingZeros = false;
+  bool vrIsTrailingZeros = false;
+  uint8_t lastRemovedDigit = 0;
+  if (e2 >= 0) {
+    const uint32_t q = log10Pow2(e2);
+    e10 = (int32_t) q;
+    const int32_t k = F16_POW5_INV_BITCOUNT + pow5bits((int32_t) q) - 1;
+    const int32_t i = -e2 + (int32_t) q + k;
+    vr = mulPow5InvDivPow2(mv, q, i);
+    vp = mulPow5InvDivPow2(mp, q, i);
+    vm = mulPow5InvDivPow2(mm, q, i);
+#ifdef RYU_DEBUG
+    printf("%u * 2^%d / 10^%u\n", mv, e2, q);
+    printf("V+=%u\nV =%u\nV-=%u\n", vp, vr, vm);
+#endif
+    if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+      // We need to know one removed digit even if we are not going to loop below.
+      const int32_t l = F16_POW5_INV_BITCOUNT + pow5bits((int32_t) (q - 1)) - 1;
+      lastRemovedDigit = (uint8_t) (mulPow5InvDivPow2(mv, q - 1, -e2 + (int32_t) q - 1 + l) % 10);
+    }
+    if (q <= 5) {
+      // mp <= 2^13 + 2 < 5^6, so none of mp, mv, and mm can be a multiple of a larger power of 5.
+      // Only one of mp, mv, and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0) {
+        vrIsTrailingZeros = multipleOfPowerOf5_16(mv, q);
+      } else if (acceptBounds) {
+        vmIsTrailingZeros = multipleOfPowerOf5_16(mm, q);
+      } else {
+        vp -= multipleOfPowerOf5_16(mp, q);
+      }
+    }
+  } else {
+    const uint32_t q = log10Pow5(-e2);
+    e10 = (int32_t) q + e2;
+    const int32_t i = -e2 - (int32_t) q;
+    const int32_t k = pow5bits(i) - F16_POW5_BITCOUNT;
+    int32_t j = (int32_t) q - k;
+    vr = mulPow5divPow2(mv, (uint32_t) i, j);
+    vp = mulPow5divPow2(mp, (uint32_t) i, j);
+    vm = mulPow5divPow2(mm, (uint32_t) i, j);
+#ifdef RYU_DEBUG
+    printf("%u * 5^%d / 10^%u\n", mv, -e2, q);
+    printf("%u %d %d %d\n", q, i, k, j);
+    printf("V+=%u\nV =%u\nV-=%u\n", vp, vr, vm);
+#endif
+    if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+      j = (int32_t) q - 1 - (pow5bits(i + 1) - F16_POW5_BITCOUNT);
+      lastRemovedDigit = (uint8_t) (mulPow5divPow2(mv, (uint32_t) (i + 1), j) % 10);
+    }
+    if (q <= 1) {
+      // {vr,vp,vm} is trailing zeros if {mv,mp,mm} has at least q trailing 0 bits.
+      // mv = 4 * m2, so it always has at least two trailing 0 bits.
+      vrIsTrailingZeros = true;
+      if (acceptBounds) {
+        // mm = mv - 1 - mmShift, so it has 1 trailing 0 bit iff mmShift == 1.
+        vmIsTrailingZeros = mmShift == 1;
+      } else {
+        // mp = mv + 2, so it always has at least one trailing 0 bit.
+        --vp;
+      }
+    } else if (q < 15) {
+      // mv has at most 13 bits, so it can't be a multiple of 2^(q - 1) for larger q.
+      vrIsTrailingZeros = multipleOfPowerOf2_16(mv, q - 1);
+#ifdef RYU_DEBUG
+      printf("vr is trailing zeros=%s\n", vrIsTrailingZeros ? "true" : "false");
+#endif
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("e10=%d\n", e10);
+  printf("V+=%u\nV =%u\nV-=%u\n", vp, vr, vm);
+  printf("vm is trailing zeros=%s\n", vmIsTrailingZeros ? "true" : "false");
+  printf("vr is trailing zeros=%s\n", vrIsTrailingZeros ? "true" : "false");
+#endif
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  int32_t removed = 0;
+  uint32_t output;
+  if (vmIsTrailingZeros || vrIsTrailingZeros) {
+    // General case. This is much more common than in f2d since most 16-bit values with e2 >= 0 are
+    // small integers.
+    while (vp / 10 > vm / 10) {
+      vmIsTrailingZeros &= vm % 10 == 0;
+      vrIsTrailingZeros &= lastRemovedDigit == 0;
+      lastRemovedDigit = (uint8_t) (vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vmIsTrailingZeros) {
+      while (vm % 10 == 0) {
+        vrIsTrailingZeros &= lastRemovedDigit == 0;
+        lastRemovedDigit = (uint8_t) (vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+      // Round even if the exact number is .....50..0.
+      lastRemovedDigit = 4;
+    }
+    // We need to take vr + 1 if vr is outside bounds or we need to round up.
+    output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+  } else {
+    // Specialized for the common case.
+    while (vp / 10 > vm / 10) {
+      lastRemovedDigit = (uint8_t) (vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    // We need to take vr + 1 if vr is outside bounds or we need to round up.
+    output = vr + (vr == vm || lastRemovedDigit >= 5);
+  }
+  const int32_t exp = e10 + removed;
+
+#ifdef RYU_DEBUG
+  printf("V+=%u\nV =%u\nV-=%u\n", vp, vr, vm);
+  printf("O=%u\n", output);
+  printf("EXP=%d\n", exp);
+#endif
+
+  floating_decimal_32 fd;
+  fd.exponent = exp;
+  fd.mantissa = output;
+  return fd;
+}
+
+static inline int to_chars(const floating_decimal_32 v, const bool sign, char* const result) {
+  // Step 5: Print the decimal representation.
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  uint32_t output = v.mantissa;
+  // The output has at most 5 digits for half and 4 digits for bfloat16.
+  const uint32_t olength = decimalLength9(output);
+
+#ifdef RYU_DEBUG
+  printf("DIGITS=%u\n", v.mantissa);
+  printf("OLEN=%u\n", olength);
+  printf("EXP=%u\n", v.exponent + olength);
+#endif
+
+  // Print the decimal digits.
+  uint32_t i = 0;
+  while (output >= 100) {
+    const uint32_t c = (output % 100) << 1;
+    output /= 100;
+    memcpy(result + index + olength - i - 1, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (output >= 10) {
+    const uint32_t c = output << 1;
+    // We can't use memcpy here: the decimal dot goes between these two digits.
+    result[index + olength - i] = DIGIT_TABLE[c + 1];
+    result[index] = DIGIT_TABLE[c];
+  } else {
+    result[index] = (char) ('0' + output);
+  }
+
+  // Print decimal point if needed.
+  if (olength > 1) {
+    result[index + 1] = '.';
+    index += olength + 1;
+  } else {
+    ++index;
+  }
+
+  // Print the exponent.
+  result[index++] = 'E';
+  int32_t exp = v.exponent + (int32_t) olength - 1;
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  }
+
+  if (exp >= 10) {
+    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+    index += 2;
+  } else {
+    result[index++] = (char) ('0' + exp);
+  }
+
+  return index;
+}
+
+// Converts the given 16-bit value in a binary format with the given number of mantissa and
+// exponent bits and bias. This is inlined into the functions below, so the format parameters are
+// compile-time constants.
+static inline int f16_buffered_n(const uint16_t bits, const uint32_t mantissaBits, const uint32_t exponentBits,
+  const int32_t bias, char* const result) {
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const bool ieeeSign = ((bits >> (mantissaBits + exponentBits)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << mantissaBits) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> mantissaBits) & ((1u << exponentBits) - 1));
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << exponentBits) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+
+  const floating_decimal_32 v = h2d(ieeeMantissa, ieeeExponent, mantissaBits, bias);
+  return to_chars(v, ieeeSign, result);
+}
+
+int h2s_buffered_n(uint16_t h, char* result) {
+  return f16_buffered_n(h, HALF_MANTISSA_BITS, HALF_EXPONENT_BITS, HALF_BIAS, result);
+}
+
+int bf2s_buffered_n(uint16_t bf, char* result) {
+  return f16_buffered_n(bf, BFLOAT16_MANTISSA_BITS, BFLOAT16_EXPONENT_BITS, BFLOAT16_BIAS, result);
+}
+
+int h2s_batch(const uint16_t* values, int count, char* result, int* offsets) {
+  int index = 0;
+  for (int i = 0; i < count; ++i) {
+    offsets[i] = index;
+    index += f16_buffered_n(values[i], HALF_MANTISSA_BITS, HALF_EXPONENT_BITS, HALF_BIAS, result + index);
+  }
+  offsets[count] = index;
+  return index;
+}
+
+int bf2s_batch(const uint16_t* values, int count, char* result, int* offsets) {
+  int index = 0;
+  for (int i = 0; i < count; ++i) {
+    offsets[i] = index;
+    index += f16_buffered_n(values[i], BFLOAT16_MANTISSA_BITS, BFLOAT16_EXPONENT_BITS, BFLOAT16_BIAS, result + index);
+  }
+  offsets[count] = index;
+  return index;
+}
+
+void h2s_buffered(uint16_t h, char* result) {
+  const int index = h2s_buffered_n(h, result);
+
+  // Terminate the string.
+  result[index] = '\0';
+}
+
+void bf2s_buffered(uint16_t bf, char* result) {
+  const int index = bf2s_buffered_n(bf, result);
+
+  // Terminate the string.
+  result[index] = '\0';
+}
+
+char* h2s(uint16_t h) {
+  char* const result = (char*) malloc(12);
+  h2s_buffered(h, result);
+  return result;
+}
+
+char* bf2s(uint16_t bf) {
+  char* const result = (char*) malloc(12);
+  bf2s_buffered(bf, result);
+  return result;
+}
@@ -0,0 +1,174 @@
+// Copyright 2019 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_PARSE_BIGINT_H
+#define RYU_PARSE_BIGINT_H
+
+// Exact comparison of a decimal input with the value halfway between two adjacent floating-point
+// numbers, using simple arbitrary-precision integers. The parsers only use this when the digits
+// they drop could change the result, which is rare.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Enough for both sides of the comparison for 800 significant digits.
+#define BIGINT_MAX_LIMBS 96
+
+// An unsigned integer in base 2^32, least significant limb first, with a nonzero most significant
+// limb (or size 0 for zero).
+typedef struct bigint {
+  uint32_t size;
+  uint32_t limbs[BIGINT_MAX_LIMBS];
+} bigint;
+
+// a = a * mul + add
+static inline void bigint_mul_add(bigint* const a, const uint32_t mul, const uint32_t add) {
+  uint64_t carry = add;
+  for (uint32_t i = 0; i < a->size; ++i) {
+    const uint64_t product = (uint64_t) a->limbs[i] * mul + carry;
+    a->limbs[i] = (uint32_t) product;
+    carry = product >> 32;
+  }
+  if (carry != 0) {
+    assert(a->size < BIGINT_MAX_LIMBS);
+    a->limbs[a->size++] = (uint32_t) carry;
+  }
+}
+
+// a = a * 5^e
+static inline void bigint_mul_pow5(bigint* const a, uint32_t e) {
+  // 5^13 is the largest power of 5 that fits into 32 bits.
+  for (; e >= 13; e -= 13) {
+    bigint_mul_add(a, 1220703125u, 0);
+  }
+  uint32_t pow5 = 1;
+  for (; e > 0; --e) {
+    pow5 *= 5;
+  }
+  bigint_mul_add(a, pow5, 0);
+}
+
+// a = a * 2^shift
+static inline void bigint_shift_left(bigint* const a, const uint32_t shift) {
+  if (a->size == 0) {
+    return;
+  }
+  const uint32_t limbShift = shift / 32;
+  const uint32_t bitShift = shift % 32;
+  assert(a->size + limbShift + 1 <= BIGINT_MAX_LIMBS);
+  if (bitShift != 0) {
+    // Shift in place from the top, so that we can move the limbs at the same time.
+    a->limbs[a->size + limbShift] = a->limbs[a->size - 1] >> (32 - bitShift);
+    for (uint32_t i = a->size - 1; i > 0; --i) {
+      a->limbs[i + limbShift] = (a->limbs[i] << bitShift) | (a->limbs[i - 1] >> (32 - bitShift));
+    }
+    a->limbs[limbShift] = a->limbs[0] << bitShift;
+    a->size += limbShift + (a->limbs[a->size + limbShift] != 0);
+  } else {
+    for (uint32_t i = a->size; i > 0; --i) {
+      a->limbs[i - 1 + limbShift] = a->limbs[i - 1];
+    }
+    a->size += limbShift;
+  }
+  for (uint32_t i = 0; i < limbShift; ++i) {
+    a->limbs[i] = 0;
+  }
+}
+
+// Returns -1, 0, or 1 if a is less than, equal to, or greater than b.
+static inline int bigint_compare(const bigint* const a, const bigint* const b) {
+  if (a->size != b->size) {
+    return a->size < b->size ? -1 : 1;
+  }
+  for (uint32_t i = a->size; i > 0; --i) {
+    if (a->limbs[i - 1] != b->limbs[i - 1]) {
+      return a->limbs[i - 1] < b->limbs[i - 1] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// Compares the decimal number N * 10^e10, where N is the integer formed by the digits in
+// buffer[begin, end) (skipping the decimal and group separators, if any), with the value halfway
+// between m2 * 2^e2 and (m2 + 1) * 2^e2, i.e., (2 * m2 + 1) * 2^(e2 - 1). Returns -1, 0, or 1 if the
+// decimal number is less than, equal to, or greater than the halfway value.
+//
+// Only the first maxDigits significant digits are used exactly; any later nonzero digit just
+// makes the number larger. This is exact if the halfway value has fewer than maxDigits significant
+// digits and is within a factor of 10 of the decimal number.
+static inline int compare_to_halfway(const char* const buffer, const int begin, const int end, int32_t e10,
+  const uint64_t m2, const int32_t e2, const uint32_t maxDigits) {
+  bigint lhs;
+  lhs.size = 0;
+  uint32_t digits = 0;
+  uint32_t chunk = 0;
+  uint32_t chunkPow10 = 1;
+  bool sticky = false;
+  for (int i = begin; i < end; ++i) {
+    const char c = buffer[i];
+    if (c < '0' || c > '9' || (digits == 0 && c == '0')) {
+      continue;
+    }
+    if (digits == maxDigits) {
+      sticky |= c != '0';
+      ++e10;
+      continue;
+    }
+    chunk = 10 * chunk + (uint32_t) (c - '0');
+    chunkPow10 *= 10;
+    ++digits;
+    if (chunkPow10 == 1000000000) {
+      bigint_mul_add(&lhs, chunkPow10, chunk);
+      chunk = 0;
+      chunkPow10 = 1;
+    }
+  }
+  bigint_mul_add(&lhs, chunkPow10, chunk);
+  if (sticky) {
+    // The dropped digits are less than one unit of the last kept digit, so N * 10 + 1 compares the
+    // same way with the halfway value.
+    bigint_mul_add(&lhs, 10, 1);
+    --e10;
+  }
+
+  const uint64_t halfway = 2 * m2 + 1;
+  bigint rhs;
+  rhs.size = 0;
+  bigint_mul_add(&rhs, 1, (uint32_t) (halfway >> 32));
+  bigint_shift_left(&rhs, 32);
+  bigint_mul_add(&rhs, 1, (uint32_t) halfway);
+
+  // Compare N * 5^e10 * 2^e10 with halfway * 2^(e2 - 1), or, if e10 is negative, N with
+  // halfway * 5^-e10 * 2^(e2 - 1 - e10). Then cancel the common powers of two.
+  int32_t lhsTwos = 0;
+  int32_t rhsTwos = e2 - 1;
+  if (e10 >= 0) {
+    bigint_mul_pow5(&lhs, (uint32_t) e10);
+    lhsTwos += e10;
+  } else {
+    bigint_mul_pow5(&rhs, (uint32_t) -e10);
+    rhsTwos -= e10;
+  }
+  if (lhsTwos < rhsTwos) {
+    bigint_shift_left(&rhs, (uint32_t) (rhsTwos - lhsTwos));
+  } else {
+    bigint_shift_left(&lhs, (uint32_t) (lhsTwos - rhsTwos));
+  }
+  return bigint_compare(&lhs, &rhs);
+}
+
+#endif // RYU_PARSE_BIGINT_H
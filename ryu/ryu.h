@@ -22,15 +22,163 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
+#include <stdbool.h>
+
+#include "ryu_separators.h"
+
+// A floating decimal representing m * 10^e.
+typedef struct floating_decimal_64 {
+  uint64_t mantissa;
+  // Decimal exponent's range is -324 to 308
+  // inclusive, and can fit in a short if needed.
+  int32_t exponent;
+} floating_decimal_64;
+
+// A floating decimal representing m * 10^e.
+typedef struct floating_decimal_32 {
+  uint32_t mantissa;
+  // Decimal exponent's range is -45 to 38
+  // inclusive, and can fit in a short if needed.
+  int32_t exponent;
+} floating_decimal_32;
+
+// The kind of value returned by double_to_fd64 and float_to_fd32.
+enum ryu_class {
+  RYU_FINITE,
+  RYU_ZERO,
+  RYU_INFINITE,
+  RYU_NAN
+};
 
 int d2s_buffered_n(double f, char* result);
 void d2s_buffered(double f, char* result);
 char* d2s(double f);
 
+// Computes the shortest decimal representation of f, i.e., the digits and exponent printed by d2s,
+// without trailing zeros in the mantissa. Stores the sign bit of f in sign. If f is finite and
+// nonzero, stores the decimal representation in result and returns RYU_FINITE; otherwise, stores
+// 0 * 10^0 in result and returns the kind of f.
+enum ryu_class double_to_fd64(double f, bool* sign, floating_decimal_64* result);
+
+// Same as d2s_buffered_n, but may write past the end of the returned string: result must have
+// room for 32 characters even if the output is shorter. This avoids the data-dependent branches for
+// the sign, the decimal dot, and the exponent digits.
+int d2s_slack_buffered_n(double f, char* result);
+
+// Converts count doubles to their shortest representations, as returned by d2s_buffered_n, and
+// stores them back-to-back in result without separators or terminating null characters. The i-th
+// string occupies result[offsets[i]] up to (excluding) result[offsets[i + 1]], so offsets must have
+// room for count + 1 entries. result must have room for 24 * count characters. Returns the total
+// number of characters written.
+int d2s_batch(const double* values, int count, char* result, int* offsets);
+
+// Same as d2s_buffered_n, but prints the shortest representation in positional notation without
+// an exponent, e.g., 123.45 instead of 1.2345E2, and 0 instead of 0E0. Integers are printed without
+// a decimal dot. result must have room for 327 characters (for -5E-324 printed as -0.000...0005).
+int d2s_fixed_shortest_buffered_n(double f, char* result);
+
+// Same as d2s_fixed_shortest_buffered_n, but with the given digit grouping and decimal separator,
+// e.g., 1,234,567.5 with { ',', 3, '.' }. result must have room for
+// 327 + 308 / separators->group_size characters, or 327 without grouping.
+int d2s_fixed_shortest_grouped_buffered_n(double f, const ryu_separators* separators, char* result);
+
+// Same as d2s_buffered_n, but matches the output of Number.prototype.toString in ECMAScript
+// (JavaScript): positional notation for 1e-6 <= |f| < 1e21, e.g., 123.45 or 0.000001, and
+// exponential notation with a lowercase e and an explicit exponent sign otherwise, e.g., 1.5e+21 or
+// 1e-7. Negative zero is printed as 0. result must have room for 25 characters.
+int d2s_ecmascript_buffered_n(double f, char* result);
+
+// Output format for d2s_format_buffered_n and f2s_format_buffered_n. The format used by
+// d2s_buffered_n and f2s_buffered_n is { 'E', false, 1, false, "Infinity", "NaN" }.
+typedef struct ryu_format {
+  // The character that separates the significand from the exponent, e.g., 'E' or 'e'.
+  char exponent_char;
+  // Whether to print a '+' before non-negative exponents, e.g., 1E+2 instead of 1E2.
+  bool exponent_sign;
+  // The minimum number of exponent digits, at most 3. Shorter exponents are padded with leading
+  // zeros, e.g., 1E02 for 2.
+  uint32_t min_exponent_digits;
+  // Whether to print a significand with a single digit as, e.g., 1.0E2 instead of 1E2.
+  bool trailing_dot_zero;
+  // The spellings of infinity (which is preceded by a '-' if negative) and NaN.
+  const char* infinity;
+  const char* nan;
+} ryu_format;
+
+// Same as d2s_buffered_n, but uses the given format. result must have room for 24 characters, or
+// for 1 + strlen(format->infinity) or strlen(format->nan) characters if these are longer.
+int d2s_format_buffered_n(double f, const ryu_format* format, char* result);
+
 int f2s_buffered_n(float f, char* result);
 void f2s_buffered(float f, char* result);
 char* f2s(float f);
 
+// Same as d2s_batch, but for floats: converts count floats to their shortest representations, as
+// returned by f2s_buffered_n. result must have room for 15 * count characters.
+int f2s_batch(const float* values, int count, char* result, int* offsets);
+
+// Same as double_to_fd64, but for floats and f2s.
+enum ryu_class float_to_fd32(float f, bool* sign, floating_decimal_32* result);
+
+// Same as f2s_buffered_n, but prints the shortest representation in positional notation without
+// an exponent, e.g., 123.45 instead of 1.2345E2, and 0 instead of 0E0. Integers are printed without
+// a decimal dot. result must have room for 48 characters (for -1E-45 printed as -0.000...0001).
+int f2s_fixed_shortest_buffered_n(float f, char* result);
+
+// Same as f2s_buffered_n, but uses the given format. result must have room for 16 characters, or
+// for 1 + strlen(format->infinity) or strlen(format->nan) characters if these are longer.
+int f2s_format_buffered_n(float f, const ryu_format* format, char* result);
+
+// Same as f2s_buffered_n, but for the 16-bit formats IEEE binary16 (half) and bfloat16, passed as
+// their bit patterns. The output is the shortest representation that round-trips to the 16-bit
+// value, which is usually shorter than the output of f2s for the value widened to float. result
+// must have room for 10 characters.
+int h2s_buffered_n(uint16_t h, char* result);
+void h2s_buffered(uint16_t h, char* result);
+char* h2s(uint16_t h);
+
+int bf2s_buffered_n(uint16_t bf, char* result);
+void bf2s_buffered(uint16_t bf, char* result);
+char* bf2s(uint16_t bf);
+
+// Same as d2s_batch, but for half and bfloat16 values. result must have room for 10 * count
+// characters.
+int h2s_batch(const uint16_t* values, int count, char* result, int* offsets);
+int bf2s_batch(const uint16_t* values, int count, char* result, int* offsets);
+
+// Same as f2s_buffered_n, but for the 8-bit formats E4M3 and E5M2 as defined in the OCP 8-bit
+// floating point specification, passed as their bit patterns. E4M3 has no infinities and prints
+// its only NaN (S.1111.111) as NaN. These copy the output from a precomputed table and may write
+// past the end of the returned string: result must have room for 16 characters.
+int fp8_e4m3_buffered_n(uint8_t bits, char* result);
+int fp8_e5m2_buffered_n(uint8_t bits, char* result);
+
+// Same as d2s_batch, but for E4M3 and E5M2 values. result must have room for 9 * count + 7
+// characters.
+int fp8_e4m3_batch(const uint8_t* values, int count, char* result, int* offsets);
+int fp8_e5m2_batch(const uint8_t* values, int count, char* result, int* offsets);
+
+// An optional direct-mapped cache of d2s and f2s results for callers that convert the same values
+// over and over. A hit copies the stored string instead of running Ryu. A cache is not
+// thread-safe; use one per thread.
+typedef struct ryu_cache ryu_cache;
+
+typedef struct ryu_cache_stats {
+  uint64_t hits;
+  uint64_t misses;
+} ryu_cache_stats;
+
+// Allocates a cache with room for the given number of double and float results each, rounded up to
+// a power of two. Each double entry takes 32 bytes, and each float entry 20 bytes. Returns NULL if
+// the allocation fails.
+ryu_cache* ryu_cache_new(uint32_t entries);
+void ryu_cache_free(ryu_cache* cache);
+ryu_cache_stats ryu_cache_get_stats(const ryu_cache* cache);
+
+// Same as d2s_buffered_n and f2s_buffered_n, using and updating the given cache.
+int d2s_cached_buffered_n(ryu_cache* cache, double f, char* result);
+int f2s_cached_buffered_n(ryu_cache* cache, float f, char* result);
+
 int d2fixed_buffered_n(double d, uint32_t precision, char* result);
 void d2fixed_buffered(double d, uint32_t precision, char* result);
 char* d2fixed(double d, uint32_t precision);
@@ -39,6 +187,107 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result);
 void d2exp_buffered(double d, uint32_t precision, char* result);
 char* d2exp(double d, uint32_t precision);
 
+// Same as d2s_batch, but for d2fixed_buffered_n and d2exp_buffered_n with the same precision for
+// all values, e.g., for a table column. result must have room for (311 + precision) * count
+// characters for d2fixed_batch, and (9 + precision) * count characters for d2exp_batch.
+int d2fixed_batch(const double* values, int count, uint32_t precision, char* result, int* offsets);
+int d2exp_batch(const double* values, int count, uint32_t precision, char* result, int* offsets);
+
+// Rounding modes for d2fixed_rounded_buffered_n and d2exp_rounded_buffered_n.
+enum ryu_rounding {
+  // Round to nearest, ties to even; the default, same as printf.
+  RYU_ROUND_HALF_EVEN,
+  // Round to nearest, ties away from zero.
+  RYU_ROUND_HALF_UP,
+  // Round toward zero.
+  RYU_ROUND_TRUNCATE,
+  // Round toward negative infinity.
+  RYU_ROUND_FLOOR,
+  // Round toward positive infinity.
+  RYU_ROUND_CEIL
+};
+
+// Same as d2fixed_buffered_n and d2exp_buffered_n, but rounds the exact value of d to precision
+// digits using the given rounding mode. Negative values that round to zero keep their sign.
+int d2fixed_rounded_buffered_n(double d, uint32_t precision, enum ryu_rounding mode, char* result);
+int d2exp_rounded_buffered_n(double d, uint32_t precision, enum ryu_rounding mode, char* result);
+
+// Same as d2fixed_buffered_n, but with the given digit grouping and decimal separator, e.g.,
+// 1.234.567,89 for 1234567.891 with precision 2 and { '.', 3, ',' }. result must have room for
+// 311 + precision + 308 / separators->group_size characters, or 311 + precision without grouping.
+int d2fixed_grouped_buffered_n(double d, uint32_t precision, const ryu_separators* separators, char* result);
+
+// A resumable form of d2fixed_buffered_n and d2exp_buffered_n that produces the output in chunks
+// of any size, e.g., to write it directly into fixed-size I/O buffers. Initialize the stream with
+// d2fixed_stream_init or d2exp_stream_init, then call ryu_stream_next repeatedly; it writes up to
+// size characters to result and returns their count, or 0 once the output is complete. The
+// concatenated chunks are identical to the output of d2fixed_buffered_n or d2exp_buffered_n.
+// Rounding is resolved during initialization, so every character is final once written, and the
+// caller can stop at any time. The fields are private.
+typedef struct ryu_stream {
+  uint64_t m2;
+  int32_t e2;
+  // Positions of decimal digits: the digit at position p has the value 10^p.
+  int32_t position;
+  int32_t last;
+  int32_t point;
+  // Rounding up adds 1 at position carry and turns all lower digits into 0; INT32_MIN if none.
+  int32_t carry;
+  // The 9-digit block at block * 9, as characters.
+  int32_t block;
+  char blockChars[9];
+  // The sign or a special value before the digits, and the exponent after them.
+  char prefix[10];
+  char suffix[6];
+  uint8_t prefixLength;
+  uint8_t suffixLength;
+  uint8_t stage;
+  uint8_t offset;
+} ryu_stream;
+
+void d2fixed_stream_init(ryu_stream* stream, double d, uint32_t precision);
+void d2exp_stream_init(ryu_stream* stream, double d, uint32_t precision);
+int ryu_stream_next(ryu_stream* stream, char* result, int size);
+
+// Flags for d2general.
+// Keep trailing zeros and always print a decimal point, like the '#' flag of printf.
+#define RYU_ALTERNATE_FORM 1
+
+// Same as printf's %.<precision>g: rounds to precision significant digits (1 if precision is 0),
+// and uses the format of d2exp if the decimal exponent X of the result is less than -4 or at least
+// precision, and otherwise that of d2fixed with precision - 1 - X digits after the decimal point.
+// Then removes trailing zeros and a trailing decimal point, unless flags contains
+// RYU_ALTERNATE_FORM. The digits are only generated once. result must have room for
+// max(precision, 1) + 8 characters, which includes "-Infinity".
+int d2general_buffered_n(double d, uint32_t precision, uint32_t flags, char* result);
+void d2general_buffered(double d, uint32_t precision, uint32_t flags, char* result);
+char* d2general(double d, uint32_t precision, uint32_t flags);
+
+// Flags for d2eng.
+// Print the exponent as an SI prefix, e.g., 12.5k instead of 12.5e+03. The prefix for 10^-6 is the
+// micro sign U+00B5 in UTF-8. Exponents outside of the range of the prefixes, from q (10^-30) to Q
+// (10^30), are still printed as exponents.
+#define RYU_SI_PREFIX 2
+
+// Same as d2exp, but in engineering notation: the exponent is a multiple of 3, with one to three
+// digits before the decimal point, e.g., 12.5e+03. As in d2general, precision is the number of
+// significant digits, and 0 means 1. If there are fewer significant digits than digits before the
+// decimal point, the rest are zeros, e.g., 10e+03 for 12345 with precision 1. result must have room
+// for precision + 10 characters.
+int d2eng_buffered_n(double d, uint32_t precision, uint32_t flags, char* result);
+void d2eng_buffered(double d, uint32_t precision, uint32_t flags, char* result);
+char* d2eng(double d, uint32_t precision, uint32_t flags);
+
+// Same as d2fixed and d2exp for the float widened to double, but faster. f2fixed_buffered_n needs
+// room for 42 + precision characters, and f2exp_buffered_n for 7 + max(precision, 2) characters.
+int f2fixed_buffered_n(float f, uint32_t precision, char* result);
+void f2fixed_buffered(float f, uint32_t precision, char* result);
+char* f2fixed(float f, uint32_t precision);
+
+int f2exp_buffered_n(float f, uint32_t precision, char* result);
+void f2exp_buffered(float f, uint32_t precision, char* result);
+char* f2exp(float f, uint32_t precision);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,123 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include "ryu/ryu.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ryu/common.h"
+
+// A cached d2s_buffered_n result. A length of 0 marks an empty entry. Results with 24 characters
+// are not cached, so that an entry fits into 32 bytes.
+typedef struct ryu_cache_entry_64 {
+  uint64_t bits;
+  char length;
+  char str[23];
+} ryu_cache_entry_64;
+
+// A cached f2s_buffered_n result. A length of 0 marks an empty entry.
+typedef struct ryu_cache_entry_32 {
+  uint32_t bits;
+  char length;
+  char str[15];
+} ryu_cache_entry_32;
+
+struct ryu_cache {
+  // The index of an entry is given by the top 'shift' bits of the hashed key.
+  uint32_t shift;
+  ryu_cache_entry_64* entries64;
+  ryu_cache_entry_32* entries32;
+  ryu_cache_stats stats;
+};
+
+ryu_cache* ryu_cache_new(uint32_t entries) {
+  uint32_t log2Entries = 0;
+  while (log2Entries < 31 && (1u << log2Entries) < entries) {
+    ++log2Entries;
+  }
+  ryu_cache* const cache = (ryu_cache*) malloc(sizeof(ryu_cache));
+  if (cache == NULL) {
+    return NULL;
+  }
+  cache->shift = 64 - log2Entries;
+  cache->entries64 = (ryu_cache_entry_64*) calloc((size_t) 1 << log2Entries, sizeof(ryu_cache_entry_64));
+  cache->entries32 = (ryu_cache_entry_32*) calloc((size_t) 1 << log2Entries, sizeof(ryu_cache_entry_32));
+  if (cache->entries64 == NULL || cache->entries32 == NULL) {
+    ryu_cache_free(cache);
+    return NULL;
+  }
+  memset(&cache->stats, 0, sizeof(ryu_cache_stats));
+  return cache;
+}
+
+void ryu_cache_free(ryu_cache* cache) {
+  if (cache != NULL) {
+    free(cache->entries64);
+    free(cache->entries32);
+    free(cache);
+  }
+}
+
+ryu_cache_stats ryu_cache_get_stats(const ryu_cache* cache) {
+  return cache->stats;
+}
+
+// Fibonacci hashing: multiplying by 2^64 / phi spreads nearby bit patterns, e.g., small integers
+// that only differ in the upper mantissa bits, over the whole table.
+static inline uint32_t cache_index(const ryu_cache* const cache, const uint64_t key) {
+  // A shift by 64 is undefined, so we shift twice for a table with a single entry.
+  return (uint32_t) (((key * 0x9E3779B97F4A7C15u) >> 1) >> (cache->shift - 1));
+}
+
+int d2s_cached_buffered_n(ryu_cache* cache, double f, char* result) {
+  const uint64_t bits = double_to_bits(f);
+  ryu_cache_entry_64* const entry = &cache->entries64[cache_index(cache, bits)];
+  if (entry->bits == bits && entry->length != 0) {
+    ++cache->stats.hits;
+    // Copying the whole entry is faster than copying exactly 'length' characters.
+    memcpy(result, entry->str, sizeof(entry->str));
+    return entry->length;
+  }
+  ++cache->stats.misses;
+  const int length = d2s_buffered_n(f, result);
+  if (length <= (int) sizeof(entry->str)) {
+    entry->bits = bits;
+    entry->length = (char) length;
+    memcpy(entry->str, result, (size_t) length);
+  }
+  return length;
+}
+
+int f2s_cached_buffered_n(ryu_cache* cache, float f, char* result) {
+  const uint32_t bits = float_to_bits(f);
+  ryu_cache_entry_32* const entry = &cache->entries32[cache_index(cache, bits)];
+  if (entry->bits == bits && entry->length != 0) {
+    ++cache->stats.hits;
+    memcpy(result, entry->str, sizeof(entry->str));
+    return entry->length;
+  }
+  ++cache->stats.misses;
+  const int length = f2s_buffered_n(f, result);
+  assert(length <= (int) sizeof(entry->str));
+  entry->bits = bits;
+  entry->length = (char) length;
+  memcpy(entry->str, result, (size_t) length);
+  return length;
+}
@@ -21,10 +21,14 @@
 extern "C" {
 #endif
 
-// This is an experimental implementation of parsing strings to 64-bit floats
-// using a Ryu-like algorithm. At this time, it only support up to 17 non-zero
-// digits in the input, and also does not support all formats. Use at your own
-// risk.
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ryu_separators.h"
+
+// This is an experimental implementation of parsing strings to 64-bit and 32-bit
+// floats using a Ryu-like algorithm. Neither supports all formats. Use at your
+// own risk.
 
 enum Status {
   SUCCESS,
@@ -33,12 +37,34 @@ enum Status {
   MALFORMED_INPUT
 };
 
+// Accepts any number of digits and rounds correctly (ties to even). Inputs with up to 19
+// significant digits take the fast path; longer inputs only need an exact (slower) comparison if
+// the digits after the first 19 could change the result.
 enum Status s2d_n(const char * buffer, const int len, double * result);
 enum Status s2d(const char * buffer, double * result);
 
+// Accepts any number of digits and rounds correctly (ties to even). Inputs with up to 9 significant
+// digits take the fast path; longer inputs only need an exact (slower) comparison if the digits
+// after the first 9 could change the result.
 enum Status s2f_n(const char * buffer, const int len, float * result);
 enum Status s2f(const char * buffer, float * result);
 
+// Same as s2d_n and s2f_n, but with the given digit grouping and decimal separator, e.g.,
+// 1.234.567,89 with { '.', 3, ',' }. Group separators are optional, but if there are any, they
+// must separate all groups of the integer part: the first group has 1 to group_size digits, and
+// all others exactly group_size digits. Anything else, e.g., 12,34 or a group separator after the
+// decimal separator, returns MALFORMED_INPUT.
+enum Status s2d_grouped_n(const char * buffer, const int len, const ryu_separators * separators, double * result);
+enum Status s2f_grouped_n(const char * buffer, const int len, const ryu_separators * separators, float * result);
+
+// Parses a string into the bit pattern of the nearest E4M3 or E5M2 value (ties to even), the
+// reverse of fp8_e4m3_buffered_n and fp8_e5m2_buffered_n. Accepts the same inputs as s2d_n, as well
+// as NaN, Infinity, and -Infinity. Values that are too large for the format, including infinities,
+// become the largest finite value of the same sign if saturate is set, and otherwise infinity
+// (E5M2) or NaN (E4M3, which has no infinities). NaN is returned as 0x7f.
+enum Status s2fp8_e4m3_n(const char * buffer, const int len, const bool saturate, uint8_t * result);
+enum Status s2fp8_e5m2_n(const char * buffer, const int len, const bool saturate, uint8_t * result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,35 @@
+// Copyright 2019 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_SEPARATORS_H
+#define RYU_SEPARATORS_H
+
+#include <stdint.h>
+
+// Digit grouping and decimal separator for the positional writers in ryu.h and the parsers in
+// ryu_parse.h, e.g., { ',', 3, '.' } for 1,234,567.89 or { '.', 3, ',' } for 1.234.567,89. Only
+// the integer part is grouped, from the decimal separator to the left.
+typedef struct ryu_separators {
+  // The character between groups of digits, or '\0' for no grouping.
+  char group_char;
+  // The number of digits per group, or 0 for no grouping; ignored if group_char is '\0'.
+  uint32_t group_size;
+  // The character between the integer and the fractional part, e.g., '.' or ','. Must differ from
+  // group_char.
+  char decimal_char;
+} ryu_separators;
+
+#endif // RYU_SEPARATORS_H
@@ -30,6 +30,7 @@
 
 #include "ryu/common.h"
 #include "ryu/d2s_intrinsics.h"
+#include "ryu/parse_bigint.h"
 
 #if defined(RYU_OPTIMIZE_SIZE)
 #include "ryu/d2s_small_table.h"
@@ -68,97 +69,28 @@ static inline double int64Bits2Double(uint64_t bits) {
   return f;
 }
 
-enum Status s2d_n(const char * buffer, const int len, double * result) {
-  if (len == 0) {
-    return INPUT_TOO_SHORT;
-  }
-  int m10digits = 0;
-  int e10digits = 0;
-  int dotIndex = len;
-  int eIndex = len;
-  uint64_t m10 = 0;
-  int32_t e10 = 0;
-  bool signedM = false;
-  bool signedE = false;
-  int i = 0;
-  if (buffer[i] == '-') {
-    signedM = true;
-    i++;
-  }
-  for (; i < len; i++) {
-    char c = buffer[i];
-    if (c == '.') {
-      if (dotIndex != len) {
-        return MALFORMED_INPUT;
-      }
-      dotIndex = i;
-      continue;
-    }
-    if ((c < '0') || (c > '9')) {
-      break;
-    }
-    if (m10digits >= 17) {
-      return INPUT_TOO_LONG;
-    }
-    m10 = 10 * m10 + (c - '0');
-    if (m10 != 0) {
-      m10digits++;
-    }
-  }
-  if (i < len && ((buffer[i] == 'e') || (buffer[i] == 'E'))) {
-    eIndex = i;
-    i++;
-    if (i < len && ((buffer[i] == '-') || (buffer[i] == '+'))) {
-      signedE = buffer[i] == '-';
-      i++;
-    }
-    for (; i < len; i++) {
-      char c = buffer[i];
-      if ((c < '0') || (c > '9')) {
-        return MALFORMED_INPUT;
-      }
-      if (e10digits > 3) {
-        // TODO: Be more lenient. Return +/-Infinity or +/-0 instead.
-        return INPUT_TOO_LONG;
-      }
-      e10 = 10 * e10 + (c - '0');
-      if (e10 != 0) {
-        e10digits++;
-      }
-    }
-  }
-  if (i < len) {
-    return MALFORMED_INPUT;
-  }
-  if (signedE) {
-    e10 = -e10;
-  }
-  e10 -= dotIndex < eIndex ? eIndex - dotIndex - 1 : 0;
-  if (m10 == 0) {
-    *result = signedM ? -0.0 : 0.0;
-    return SUCCESS;
-  }
-
+// Converts m10 * 10^e10, where m10 is nonzero and has m10digits digits, to the bits of the nearest
+// double (ties to even), without the sign.
+static inline uint64_t s2d_bits(const uint64_t m10, const int m10digits, const int32_t e10) {
 #ifdef RYU_DEBUG
-  printf("Input=%s\n", buffer);
   printf("m10digits = %d\n", m10digits);
-  printf("e10digits = %d\n", e10digits);
   printf("m10 * 10^e10 = %" PRIu64 " * 10^%d\n", m10, e10);
 #endif
 
   if ((m10digits + e10 <= -324) || (m10 == 0)) {
     // Number is less than 1e-324, which should be rounded down to 0; return +/-0.0.
-    uint64_t ieee = ((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS);
-    *result = int64Bits2Double(ieee);
-    return SUCCESS;
+    return 0;
   }
   if (m10digits + e10 >= 310) {
     // Number is larger than 1e+309, which should be rounded to +/-Infinity.
-    uint64_t ieee = (((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS)) | (0x7ffull << DOUBLE_MANTISSA_BITS);
-    *result = int64Bits2Double(ieee);
-    return SUCCESS;
+    return 0x7ffull << DOUBLE_MANTISSA_BITS;
   }
 
+  // Mantissas with more than 17 digits have up to 64 bits. We keep up to 8 more bits in m2 for
+  // them, so that the shift in mulShift64 stays below 128; the rounding below works for any width
+  // of m2.
+  const int32_t extraBits = max32(0, (int32_t) floor_log2(m10) - 55);
+
   // Convert to binary float m2 * 2^e2, while retaining information about whether the conversion
   // was exact (trailingZeros).
   int32_t e2;
@@ -174,7 +106,7 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
     //
     // We use floor(log2(5^e10)) so that we get at least this many bits; better to
     // have an additional bit than to not have enough bits.
-    e2 = floor_log2(m10) + e10 + log2pow5(e10) - (DOUBLE_MANTISSA_BITS + 1);
+    e2 = floor_log2(m10) + e10 + log2pow5(e10) - (DOUBLE_MANTISSA_BITS + 1) - extraBits;
 
     // We now compute [m10 * 10^e10 / 2^e2] = [m10 * 5^e10 / 2^(e2-e10)].
     // To that end, we use the DOUBLE_POW5_SPLIT table.
@@ -195,7 +127,7 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
     // the result must be exact. Otherwise we use the existing multipleOfPowerOf2 function.
     trailingZeros = e2 < e10 || (e2 - e10 < 64 && multipleOfPowerOf2(m10, e2 - e10));
   } else {
-    e2 = floor_log2(m10) + e10 - ceil_log2pow5(-e10) - (DOUBLE_MANTISSA_BITS + 1);
+    e2 = floor_log2(m10) + e10 - ceil_log2pow5(-e10) - (DOUBLE_MANTISSA_BITS + 1) - extraBits;
     int j = e2 - e10 + ceil_log2pow5(-e10) - 1 + DOUBLE_POW5_INV_BITCOUNT;
 #if defined(RYU_OPTIMIZE_SIZE)
     uint64_t pow5[2];
@@ -205,7 +137,10 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
     assert(-e10 < DOUBLE_POW5_INV_TABLE_SIZE);
     m2 = mulShift64(m10, DOUBLE_POW5_INV_SPLIT[-e10], j);
 #endif
-    trailingZeros = multipleOfPowerOf5(m10, -e10);
+    // As in s2f, the result is only exact if 5^(-e10) divides m10, and, if e2 - e10 is positive,
+    // 2^(e2 - e10) also divides m10.
+    trailingZeros = (e2 < e10 || (e2 - e10 < 64 && multipleOfPowerOf2(m10, e2 - e10)))
+        && multipleOfPowerOf5(m10, -e10);
   }
 
 #ifdef RYU_DEBUG
@@ -217,9 +152,7 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
 
   if (ieee_e2 > 0x7fe) {
     // Final IEEE exponent is larger than the maximum representable; return +/-Infinity.
-    uint64_t ieee = (((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS)) | (0x7ffull << DOUBLE_MANTISSA_BITS);
-    *result = int64Bits2Double(ieee);
-    return SUCCESS;
+    return 0x7ffull << DOUBLE_MANTISSA_BITS;
   }
 
   // We need to figure out how much we need to shift m2. The tricky part is that we need to take
@@ -227,6 +160,13 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
   // the value 0.
   int32_t shift = (ieee_e2 == 0 ? 1 : ieee_e2) - e2 - DOUBLE_EXPONENT_BIAS - DOUBLE_MANTISSA_BITS;
   assert(shift >= 0);
+  if (shift > 63) {
+    // Only possible with extra bits, for values below the smallest subnormal. Dropping the lowest
+    // bits of m2 still leaves the last removed bit for the rounding below.
+    trailingZeros &= (m2 & ((1ull << (shift - 63)) - 1)) == 0;
+    m2 >>= shift - 63;
+    shift = 63;
+  }
 #ifdef RYU_DEBUG
   printf("ieee_e2 = %d\n", ieee_e2);
   printf("shift = %d\n", shift);
@@ -252,12 +192,158 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
     // Due to how the IEEE represents +/-Infinity, we don't need to check for overflow here.
     ieee_e2++;
   }
-  
-  uint64_t ieee = (((((uint64_t) signedM) << DOUBLE_EXPONENT_BITS) | (uint64_t)ieee_e2) << DOUBLE_MANTISSA_BITS) | ieee_m2;
+  return (((uint64_t) ieee_e2) << DOUBLE_MANTISSA_BITS) | ieee_m2;
+}
+
+static inline enum Status s2d_separated_n(const char * const buffer, const int len, const char groupChar,
+  const uint32_t groupSize, const char decimalChar, double * const result) {
+  if (len == 0) {
+    return INPUT_TOO_SHORT;
+  }
+  int m10digits = 0;
+  int e10digits = 0;
+  int dotIndex = len;
+  int eIndex = len;
+  uint64_t m10 = 0;
+  int32_t e10 = 0;
+  // Digits after the first 19 significant digits are not part of m10; we only track how many
+  // there are and whether any of them is nonzero.
+  int droppedDigits = 0;
+  bool truncated = false;
+  bool signedM = false;
+  bool signedE = false;
+  int i = 0;
+  if (buffer[i] == '-') {
+    signedM = true;
+    i++;
+  }
+  const int mantissaBegin = i;
+  // The number of digits since the last group separator, and whether there was one.
+  uint32_t groupDigits = 0;
+  bool grouped = false;
+  for (; i < len; i++) {
+    char c = buffer[i];
+    if (c == decimalChar) {
+      if (dotIndex != len || (grouped && groupDigits != groupSize)) {
+        return MALFORMED_INPUT;
+      }
+      dotIndex = i;
+      continue;
+    }
+    if (c == groupChar && groupChar != '\0') {
+      // Group separators are only allowed in the integer part. The first group has 1 to groupSize
+      // digits, and all later groups exactly groupSize digits.
+      if (dotIndex != len || groupDigits == 0 || groupDigits > groupSize || (grouped && groupDigits != groupSize)) {
+        return MALFORMED_INPUT;
+      }
+      grouped = true;
+      groupDigits = 0;
+      continue;
+    }
+    if ((c < '0') || (c > '9')) {
+      break;
+    }
+    groupDigits++;
+    if (m10digits >= 19) {
+      droppedDigits++;
+      truncated |= c != '0';
+      continue;
+    }
+    m10 = 10 * m10 + (c - '0');
+    if (m10 != 0) {
+      m10digits++;
+    }
+  }
+  const int mantissaEnd = i;
+  if (grouped && dotIndex == len && groupDigits != groupSize) {
+    return MALFORMED_INPUT;
+  }
+  if (i < len && ((buffer[i] == 'e') || (buffer[i] == 'E'))) {
+    eIndex = i;
+    i++;
+    if (i < len && ((buffer[i] == '-') || (buffer[i] == '+'))) {
+      signedE = buffer[i] == '-';
+      i++;
+    }
+    for (; i < len; i++) {
+      char c = buffer[i];
+      if ((c < '0') || (c > '9')) {
+        return MALFORMED_INPUT;
+      }
+      if (e10digits > 3) {
+        // TODO: Be more lenient. Return +/-Infinity or +/-0 instead.
+        return INPUT_TOO_LONG;
+      }
+      e10 = 10 * e10 + (c - '0');
+      if (e10 != 0) {
+        e10digits++;
+      }
+    }
+  }
+  if (i < len) {
+    return MALFORMED_INPUT;
+  }
+  if (signedE) {
+    e10 = -e10;
+  }
+  e10 -= dotIndex < eIndex ? eIndex - dotIndex - 1 : 0;
+  if (m10 == 0) {
+    *result = signedM ? -0.0 : 0.0;
+    return SUCCESS;
+  }
+  // The value of all the mantissa digits is m10 * 10^(e10 + droppedDigits) plus the dropped digits.
+  const int32_t e10All = e10;
+  e10 += droppedDigits;
+  if (e10 < -341 && m10digits + e10 > -324) {
+    // The table of inverse powers of 5 ends at 5^341, which only 19-digit mantissas just above
+    // 1e-324 exceed. Treat their last digit as dropped.
+    truncated |= m10 % 10 != 0;
+    m10 /= 10;
+    m10digits--;
+    e10++;
+  }
+
+#ifdef RYU_DEBUG
+  printf("Input=%s\n", buffer);
+  printf("e10digits = %d\n", e10digits);
+  printf("droppedDigits = %d, truncated = %d\n", droppedDigits, truncated);
+#endif
+
+  uint64_t ieee = s2d_bits(m10, m10digits, e10);
+  if (truncated) {
+    // The exact value is strictly between m10 * 10^e10 and (m10 + 1) * 10^e10. Rounding is
+    // monotonic, so if both round to the same double, then so does the exact value, which is the
+    // common case. Otherwise they are adjacent doubles (the interval is much smaller than an ulp),
+    // and we compare the exact value with the halfway point between them.
+    const uint64_t upper = s2d_bits(m10 + 1, m10digits + (m10 + 1 == 10000000000000000000ull), e10);
+    if (upper != ieee) {
+      const uint32_t ieeeExponent = (uint32_t) (ieee >> DOUBLE_MANTISSA_BITS);
+      const uint64_t ieeeMantissa = ieee & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+      const uint64_t m2 = ieeeExponent == 0 ? ieeeMantissa : ieeeMantissa | (1ull << DOUBLE_MANTISSA_BITS);
+      const int32_t e2 = (ieeeExponent == 0 ? 1 : (int32_t) ieeeExponent) - DOUBLE_EXPONENT_BIAS - DOUBLE_MANTISSA_BITS;
+      // The halfway point of a double has at most 767 significant digits.
+      const int cmp = compare_to_halfway(buffer, mantissaBegin, mantissaEnd, e10All, m2, e2, 800);
+#ifdef RYU_DEBUG
+      printf("upper = %016" PRIx64 ", cmp = %d\n", upper, cmp);
+#endif
+      ieee += cmp > 0 || (cmp == 0 && (ieee & 1) != 0);
+    }
+  }
+  ieee |= ((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS);
   *result = int64Bits2Double(ieee);
   return SUCCESS;
 }
 
+enum Status s2d_n(const char * buffer, const int len, double * result) {
+  return s2d_separated_n(buffer, len, '\0', 0, '.', result);
+}
+
+enum Status s2d_grouped_n(const char * buffer, const int len, const ryu_separators * separators, double * result) {
+  // A group size of 0 disables grouping, like a '\0' group_char.
+  const char groupChar = separators->group_size == 0 ? '\0' : separators->group_char;
+  return s2d_separated_n(buffer, len, groupChar, separators->group_size, separators->decimal_char, result);
+}
+
 enum Status s2d(const char * buffer, double * result) {
   return s2d_n(buffer, strlen(buffer), result);
 }
@@ -30,6 +30,7 @@
 
 #include "ryu/common.h"
 #include "ryu/f2s_intrinsics.h"
+#include "ryu/parse_bigint.h"
 
 #define FLOAT_MANTISSA_BITS 23
 #define FLOAT_EXPONENT_BITS 8
@@ -62,95 +63,21 @@ static inline float int32Bits2Float(uint32_t bits) {
   return f;
 }
 
-enum Status s2f_n(const char * buffer, const int len, float * result) {
-  if (len == 0) {
-    return INPUT_TOO_SHORT;
-  }
-  int m10digits = 0;
-  int e10digits = 0;
-  int dotIndex = len;
-  int eIndex = len;
-  uint32_t m10 = 0;
-  int32_t e10 = 0;
-  bool signedM = false;
-  bool signedE = false;
-  int i = 0;
-  if (buffer[i] == '-') {
-    signedM = true;
-    i++;
-  }
-  for (; i < len; i++) {
-    char c = buffer[i];
-    if (c == '.') {
-      if (dotIndex != len) {
-        return MALFORMED_INPUT;
-      }
-      dotIndex = i;
-      continue;
-    }
-    if ((c < '0') || (c > '9')) {
-      break;
-    }
-    if (m10digits >= 9) {
-      return INPUT_TOO_LONG;
-    }
-    m10 = 10 * m10 + (c - '0');
-    if (m10 != 0) {
-      m10digits++;
-    }
-  }
-  if (i < len && ((buffer[i] == 'e') || (buffer[i] == 'E'))) {
-    eIndex = i;
-    i++;
-    if (i < len && ((buffer[i] == '-') || (buffer[i] == '+'))) {
-      signedE = buffer[i] == '-';
-      i++;
-    }
-    for (; i < len; i++) {
-      char c = buffer[i];
-      if ((c < '0') || (c > '9')) {
-        return MALFORMED_INPUT;
-      }
-      if (e10digits > 3) {
-        // TODO: Be more lenient. Return +/-Infinity or +/-0 instead.
-        return INPUT_TOO_LONG;
-      }
-      e10 = 10 * e10 + (c - '0');
-      if (e10 != 0) {
-        e10digits++;
-      }
-    }
-  }
-  if (i < len) {
-    return MALFORMED_INPUT;
-  }
-  if (signedE) {
-    e10 = -e10;
-  }
-  e10 -= dotIndex < eIndex ? eIndex - dotIndex - 1 : 0;
-  if (m10 == 0) {
-    *result = signedM ? -0.0f : 0.0f;
-    return SUCCESS;
-  }
-
+// Converts m10 * 10^e10, where m10 is nonzero and has m10digits digits, to the bits of the nearest
+// float (ties to even), without the sign.
+static inline uint32_t s2f_bits(const uint32_t m10, const int m10digits, const int32_t e10) {
 #ifdef RYU_DEBUG
-  printf("Input=%s\n", buffer);
   printf("m10digits = %d\n", m10digits);
-  printf("e10digits = %d\n", e10digits);
   printf("m10 * 10^e10 = %u * 10^%d\n", m10, e10);
 #endif
 
   if ((m10digits + e10 <= -46) || (m10 == 0)) {
     // Number is less than 1e-46, which should be rounded down to 0; return +/-0.0.
-    uint32_t ieee = ((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS);
-    *result = int32Bits2Float(ieee);
-    return SUCCESS;
+    return 0;
   }
   if (m10digits + e10 >= 40) {
     // Number is larger than 1e+39, which should be rounded to +/-Infinity.
-    uint32_t ieee = (((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS)) | (0xffu << FLOAT_MANTISSA_BITS);
-    *result = int32Bits2Float(ieee);
-    return SUCCESS;
+    return 0xffu << FLOAT_MANTISSA_BITS;
   }
 
   // Convert to binary float m2 * 2^e2, while retaining information about whether the conversion
@@ -211,9 +138,7 @@ enum Status s2f_n(const char * buffer, const int len, float * result) {
 
   if (ieee_e2 > 0xfe) {
     // Final IEEE exponent is larger than the maximum representable; return +/-Infinity.
-    uint32_t ieee = (((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS)) | (0xffu << FLOAT_MANTISSA_BITS);
-    *result = int32Bits2Float(ieee);
-    return SUCCESS;
+    return 0xffu << FLOAT_MANTISSA_BITS;
   }
 
   // We need to figure out how much we need to shift m2. The tricky part is that we need to take
@@ -248,11 +173,150 @@ enum Status s2f_n(const char * buffer, const int len, float * result) {
     // Due to how the IEEE represents +/-Infinity, we don't need to check for overflow here.
     ieee_e2++;
   }
-  uint32_t ieee = (((((uint32_t) signedM) << FLOAT_EXPONENT_BITS) | (uint32_t)ieee_e2) << FLOAT_MANTISSA_BITS) | ieee_m2;
+  return (((uint32_t) ieee_e2) << FLOAT_MANTISSA_BITS) | ieee_m2;
+}
+
+static inline enum Status s2f_separated_n(const char * const buffer, const int len, const char groupChar,
+  const uint32_t groupSize, const char decimalChar, float * const result) {
+  if (len == 0) {
+    return INPUT_TOO_SHORT;
+  }
+  int m10digits = 0;
+  int e10digits = 0;
+  int dotIndex = len;
+  int eIndex = len;
+  uint32_t m10 = 0;
+  int32_t e10 = 0;
+  // Digits after the first 9 significant digits are not part of m10; we only track how many there
+  // are and whether any of them is nonzero.
+  int droppedDigits = 0;
+  bool truncated = false;
+  bool signedM = false;
+  bool signedE = false;
+  int i = 0;
+  if (buffer[i] == '-') {
+    signedM = true;
+    i++;
+  }
+  const int mantissaBegin = i;
+  // The number of digits since the last group separator, and whether there was one.
+  uint32_t groupDigits = 0;
+  bool grouped = false;
+  for (; i < len; i++) {
+    char c = buffer[i];
+    if (c == decimalChar) {
+      if (dotIndex != len || (grouped && groupDigits != groupSize)) {
+        return MALFORMED_INPUT;
+      }
+      dotIndex = i;
+      continue;
+    }
+    if (c == groupChar && groupChar != '\0') {
+      // Group separators are only allowed in the integer part. The first group has 1 to groupSize
+      // digits, and all later groups exactly groupSize digits.
+      if (dotIndex != len || groupDigits == 0 || groupDigits > groupSize || (grouped && groupDigits != groupSize)) {
+        return MALFORMED_INPUT;
+      }
+      grouped = true;
+      groupDigits = 0;
+      continue;
+    }
+    if ((c < '0') || (c > '9')) {
+      break;
+    }
+    groupDigits++;
+    if (m10digits >= 9) {
+      droppedDigits++;
+      truncated |= c != '0';
+      continue;
+    }
+    m10 = 10 * m10 + (c - '0');
+    if (m10 != 0) {
+      m10digits++;
+    }
+  }
+  const int mantissaEnd = i;
+  if (grouped && dotIndex == len && groupDigits != groupSize) {
+    return MALFORMED_INPUT;
+  }
+  if (i < len && ((buffer[i] == 'e') || (buffer[i] == 'E'))) {
+    eIndex = i;
+    i++;
+    if (i < len && ((buffer[i] == '-') || (buffer[i] == '+'))) {
+      signedE = buffer[i] == '-';
+      i++;
+    }
+    for (; i < len; i++) {
+      char c = buffer[i];
+      if ((c < '0') || (c > '9')) {
+        return MALFORMED_INPUT;
+      }
+      if (e10digits > 3) {
+        // TODO: Be more lenient. Return +/-Infinity or +/-0 instead.
+        return INPUT_TOO_LONG;
+      }
+      e10 = 10 * e10 + (c - '0');
+      if (e10 != 0) {
+        e10digits++;
+      }
+    }
+  }
+  if (i < len) {
+    return MALFORMED_INPUT;
+  }
+  if (signedE) {
+    e10 = -e10;
+  }
+  e10 -= dotIndex < eIndex ? eIndex - dotIndex - 1 : 0;
+  if (m10 == 0) {
+    *result = signedM ? -0.0f : 0.0f;
+    return SUCCESS;
+  }
+  // The value of all the mantissa digits is m10 * 10^(e10 + droppedDigits) plus the dropped digits.
+  const int32_t e10All = e10;
+  e10 += droppedDigits;
+
+#ifdef RYU_DEBUG
+  printf("Input=%s\n", buffer);
+  printf("e10digits = %d\n", e10digits);
+  printf("droppedDigits = %d, truncated = %d\n", droppedDigits, truncated);
+#endif
+
+  uint32_t ieee = s2f_bits(m10, m10digits, e10);
+  if (truncated) {
+    // The exact value is strictly between m10 * 10^e10 and (m10 + 1) * 10^e10. Rounding is
+    // monotonic, so if both round to the same float, then so does the exact value. Otherwise they
+    // are adjacent floats (the interval is much smaller than a float ulp), and we compare the exact
+    // value with the halfway point between them.
+    const uint32_t upper = s2f_bits(m10 + 1, m10digits + (m10 + 1 == 1000000000u), e10);
+    if (upper != ieee) {
+      const uint32_t ieeeExponent = ieee >> FLOAT_MANTISSA_BITS;
+      const uint32_t ieeeMantissa = ieee & ((1u << FLOAT_MANTISSA_BITS) - 1);
+      const uint32_t m2 = ieeeExponent == 0 ? ieeeMantissa : ieeeMantissa | (1u << FLOAT_MANTISSA_BITS);
+      const int32_t e2 = (ieeeExponent == 0 ? 1 : (int32_t) ieeeExponent) - FLOAT_EXPONENT_BIAS - FLOAT_MANTISSA_BITS;
+      // The halfway point of a float has at most 112 significant digits.
+      const int cmp = compare_to_halfway(buffer, mantissaBegin, mantissaEnd, e10All, m2, e2, 120);
+#ifdef RYU_DEBUG
+      printf("upper = %08x, cmp = %d\n", upper, cmp);
+#endif
+      ieee += cmp > 0 || (cmp == 0 && (ieee & 1) != 0);
+    }
+  }
+  ieee |= ((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS);
   *result = int32Bits2Float(ieee);
   return SUCCESS;
 }
 
+enum Status s2f_n(const char * buffer, const int len, float * result) {
+  return s2f_separated_n(buffer, len, '\0', 0, '.', result);
+}
+
+enum Status s2f_grouped_n(const char * buffer, const int len, const ryu_separators * separators, float * result) {
+  // A group size of 0 disables grouping, like a '\0' group_char.
+  const char groupChar = separators->group_size == 0 ? '\0' : separators->group_char;
+  return s2f_separated_n(buffer, len, groupChar, separators->group_size, separators->decimal_char, result);
+}
+
 enum Status s2f(const char * buffer, float * result) {
   return s2f_n(buffer, strlen(buffer), result);
 }
@@ -0,0 +1,149 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Parsing for the 8-bit formats E4M3 and E5M2, the reverse of the tables in fp8_table.h.
+
+#include "ryu/ryu_parse.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ryu/common.h"
+#include "ryu/parse_bigint.h"
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BIAS 1023
+
+#define FP8_NAN 0x7fu
+
+typedef struct fp8_format {
+  uint32_t mantissaBits;
+  // The exponent of the smallest normal value.
+  int32_t minExponent;
+  // The bit patterns of the largest finite value and of +Infinity, or 0 if there is no infinity.
+  uint32_t maxFinite;
+  uint32_t infinity;
+} fp8_format;
+
+static const fp8_format E4M3 = { 3, -6, 0x7eu, 0u };
+static const fp8_format E5M2 = { 2, -14, 0x7bu, 0x7cu };
+
+// Compares the decimal number in buffer, which s2d_n has already accepted, with
+// (2 * m2 + 1) * 2^(e2 - 1), ignoring the sign; see compare_to_halfway.
+static inline int compare_input_to_halfway(const char* const buffer, const int len, const uint64_t m2,
+  const int32_t e2) {
+  const int begin = len > 0 && buffer[0] == '-';
+  int end = begin;
+  int32_t fractionDigits = 0;
+  bool afterDot = false;
+  for (; end < len && buffer[end] != 'e' && buffer[end] != 'E'; ++end) {
+    if (buffer[end] == '.') {
+      afterDot = true;
+    } else if (afterDot) {
+      ++fractionDigits;
+    }
+  }
+  int32_t e10 = 0;
+  int i = end + 1;
+  const bool signedE = i < len && buffer[i] == '-';
+  if (i < len && (buffer[i] == '-' || buffer[i] == '+')) {
+    ++i;
+  }
+  for (; i < len; ++i) {
+    e10 = 10 * e10 + (buffer[i] - '0');
+  }
+  e10 = (signedE ? -e10 : e10) - fractionDigits;
+  // The halfway points of both formats have fewer than 25 significant digits.
+  return compare_to_halfway(buffer, begin, end, e10, m2, e2, 25);
+}
+
+// Rounds the non-negative double d to the nearest multiple of the quantum of the 8-bit format at
+// d's exponent, ties to even, and returns the bit pattern of the result without the sign. The
+// result is larger than format->maxFinite if d overflows. d is the decimal input in buffer rounded
+// to double; if d is exactly halfway, the input decides which way to round.
+static inline uint32_t round_to_fp8(const double d, const fp8_format* const format, const char* const buffer,
+  const int len) {
+  const uint64_t bits = double_to_bits(d);
+  const uint32_t ieeeExponent = (uint32_t) (bits >> DOUBLE_MANTISSA_BITS);
+  if (ieeeExponent == 0) {
+    // Zero or a subnormal double, far below the smallest 8-bit value.
+    return 0;
+  }
+  // d = m2 * 2^(e - 52), and the 8-bit format has a quantum of 2^(max(e, minExponent) - mantissaBits).
+  const int32_t e = (int32_t) ieeeExponent - DOUBLE_EXPONENT_BIAS;
+  const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | (bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1));
+  const int32_t clampedE = e < format->minExponent ? format->minExponent : e;
+  const int32_t shift = clampedE - (int32_t) format->mantissaBits - e + DOUBLE_MANTISSA_BITS;
+  if (shift > DOUBLE_MANTISSA_BITS + 1) {
+    // d is less than half the smallest subnormal value.
+    return 0;
+  }
+  const uint64_t removed = m2 & ((1ull << shift) - 1);
+  const uint64_t half = 1ull << (shift - 1);
+  uint64_t r = m2 >> shift;
+  if (removed == half) {
+    // The input may be just above or below the halfway point and still round to it as a double.
+    const int cmp = compare_input_to_halfway(buffer, len, r, clampedE - (int32_t) format->mantissaBits);
+    r += cmp > 0 || (cmp == 0 && (r & 1) != 0);
+  } else {
+    r += removed > half;
+  }
+  // For normal values, r includes the implicit leading bit, which adds 1 to the exponent field. If
+  // rounding carries into the next power of 2, this also carries into the exponent field.
+  return ((uint32_t) (clampedE - format->minExponent) << format->mantissaBits) + (uint32_t) r;
+}
+
+static inline enum Status s2fp8(const char* const buffer, const int len, const fp8_format* const format,
+  const bool saturate, uint8_t* const result) {
+  const bool sign = len > 0 && buffer[0] == '-';
+  uint32_t magnitude;
+  if (len == 3 && memcmp(buffer, "NaN", 3) == 0) {
+    *result = FP8_NAN;
+    return SUCCESS;
+  }
+  if (len == 8 + sign && memcmp(buffer + sign, "Infinity", 8) == 0) {
+    magnitude = UINT32_MAX;
+  } else {
+    double d;
+    const enum Status status = s2d_n(buffer, len, &d);
+    if (status != SUCCESS) {
+      return status;
+    }
+    magnitude = round_to_fp8(sign ? -d : d, format, buffer, len);
+  }
+  if (magnitude > format->maxFinite) {
+    if (saturate) {
+      magnitude = format->maxFinite;
+    } else if (format->infinity != 0) {
+      magnitude = format->infinity;
+    } else {
+      *result = FP8_NAN;
+      return SUCCESS;
+    }
+  }
+  *result = (uint8_t) (((uint32_t) sign << 7) | magnitude);
+  return SUCCESS;
+}
+
+enum Status s2fp8_e4m3_n(const char* buffer, const int len, const bool saturate, uint8_t* result) {
+  return s2fp8(buffer, len, &E4M3, saturate, result);
+}
+
+enum Status s2fp8_e5m2_n(const char* buffer, const int len, const bool saturate, uint8_t* result) {
+  return s2fp8(buffer, len, &E5M2, saturate, result);
+}
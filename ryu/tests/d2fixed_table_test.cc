@@ -0,0 +1,50 @@
+// Copyright 2019 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <inttypes.h>
+
+#include "third_party/gtest/gtest.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/d2fixed_index_table.h"
+#include "ryu/d2fixed_small_table.h"
+#include "ryu/d2fixed_full_table.h"
+
+TEST(D2fixedTableTest, computePow10Split) {
+  for (uint32_t idx = 0; idx < TABLE_SIZE; idx++) {
+    const uint32_t end = idx + 1 < TABLE_SIZE ? POW10_OFFSET[idx + 1] : 1224;
+    for (uint32_t p = POW10_OFFSET[idx]; p < end; p++) {
+      uint64_t m[3];
+      computePow10Split(idx, p - POW10_OFFSET[idx], m);
+      EXPECT_EQ(m[0], POW10_SPLIT[p][0]);
+      EXPECT_EQ(m[1], POW10_SPLIT[p][1]);
+      EXPECT_EQ(m[2], POW10_SPLIT[p][2]);
+    }
+  }
+}
+
+TEST(D2fixedTableTest, computePow10Split2) {
+  for (uint32_t idx = 0; idx < TABLE_SIZE_2; idx++) {
+    const uint32_t end = idx + 1 < TABLE_SIZE_2 ? POW10_OFFSET_2[idx + 1] : 3133;
+    for (uint32_t p = POW10_OFFSET_2[idx]; p < end; p++) {
+      uint64_t m[3];
+      computePow10Split2(idx, p - POW10_OFFSET_2[idx] + MIN_BLOCK_2[idx], m);
+      EXPECT_EQ(m[0], POW10_SPLIT_2[p][0]);
+      EXPECT_EQ(m[1], POW10_SPLIT_2[p][1]);
+      EXPECT_EQ(m[2], POW10_SPLIT_2[p][2]);
+    }
+  }
+}
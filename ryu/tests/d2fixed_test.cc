@@ -17,6 +17,9 @@
 
 #include <math.h>
 #include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include "ryu/ryu.h"
 #include "third_party/gtest/gtest.h"
@@ -35832,6 +35835,65 @@ TEST(D2fixedTest, AllBinaryExponents) {
   }
 }
 
+TEST(D2fixedTest, SmallPrecision) {
+  // Precision <= 17 and values below 2^64 use a separate code path; these are its edge cases.
+  EXPECT_FIXED(18446744073709549568.0, 17, "18446744073709549568.00000000000000000");
+  EXPECT_FIXED(18446744073709551616.0, 17, "18446744073709551616.00000000000000000");
+  EXPECT_FIXED(0.125, 2, "0.12");
+  EXPECT_FIXED(0.375, 2, "0.38");
+  EXPECT_FIXED(2.5, 0, "2");
+  EXPECT_FIXED(3.5, 0, "4");
+  EXPECT_FIXED(4503599627370495.5, 0, "4503599627370496");
+  EXPECT_FIXED(99.995, 2, "100.00");
+  EXPECT_FIXED(9.5e-20, 17, "0.00000000000000000");
+  EXPECT_FIXED(1.2345678901234567e-3, 17, "0.00123456789012346");
+  EXPECT_FIXED(-123.456, 17, "-123.45600000000000307");
+}
+
+#define EXPECT_FIXED_ROUNDED(a, b, halfEven, halfUp, truncate, floor, ceil) { \
+    const char* const expected[] = { halfEven, halfUp, truncate, floor, ceil }; \
+    const ryu_rounding modes[] = { RYU_ROUND_HALF_EVEN, RYU_ROUND_HALF_UP, RYU_ROUND_TRUNCATE, RYU_ROUND_FLOOR, RYU_ROUND_CEIL }; \
+    for (int i = 0; i < 5; ++i) { \
+      char result[2000]; \
+      result[d2fixed_rounded_buffered_n(a, b, modes[i], result)] = '\0'; \
+      EXPECT_STREQ(expected[i], result) << "mode " << i; \
+    } \
+  } while (0);
+
+TEST(D2fixedTest, RoundingModes) {
+  // The expected values are the exact binary values rounded with Python's decimal module.
+  EXPECT_FIXED_ROUNDED(2.5, 0,
+    "2", "3", "2", "2", "3");
+  EXPECT_FIXED_ROUNDED(-2.5, 0,
+    "-2", "-3", "-2", "-3", "-2");
+  EXPECT_FIXED_ROUNDED(-0.125, 2,
+    "-0.12", "-0.13", "-0.12", "-0.13", "-0.12");
+  EXPECT_FIXED_ROUNDED(1.005, 2,
+    "1.00", "1.00", "1.00", "1.00", "1.01");
+  EXPECT_FIXED_ROUNDED(-1.005, 2,
+    "-1.00", "-1.00", "-1.00", "-1.01", "-1.00");
+  EXPECT_FIXED_ROUNDED(-2.0, 3,
+    "-2.000", "-2.000", "-2.000", "-2.000", "-2.000");
+  EXPECT_FIXED_ROUNDED(0.996, 2,
+    "1.00", "1.00", "0.99", "0.99", "1.00");
+  EXPECT_FIXED_ROUNDED(1e-300, 2,
+    "0.00", "0.00", "0.00", "0.00", "0.01");
+  EXPECT_FIXED_ROUNDED(-1e-300, 2,
+    "-0.00", "-0.00", "-0.00", "-0.01", "-0.00");
+  EXPECT_FIXED_ROUNDED(ldexp(1.0, -20), 19,
+    "0.0000009536743164062",
+    "0.0000009536743164063",
+    "0.0000009536743164062",
+    "0.0000009536743164062",
+    "0.0000009536743164063");
+  EXPECT_FIXED_ROUNDED(-1.0 / 3, 30,
+    "-0.333333333333333314829616256247",
+    "-0.333333333333333314829616256247",
+    "-0.333333333333333314829616256247",
+    "-0.333333333333333314829616256248",
+    "-0.333333333333333314829616256247");
+}
+
 TEST(D2fixedTest, Regression) {
   EXPECT_FIXED(7.018232e-82, 6, "0.000000");
 }
@@ -36028,6 +36090,62 @@ TEST(D2expTest, AllBinaryExponents) {
   }
 }
 
+TEST(D2expTest, SmallPrecision) {
+  // Precision <= 17 and values in [10^(precision - 19), 2^64) use a separate code path; these are
+  // its edge cases.
+  EXPECT_EXP(18446744073709549568.0, 17, "1.84467440737095496e+19");
+  EXPECT_EXP(18446744073709551616.0, 17, "1.84467440737095516e+19");
+  EXPECT_EXP(0.125, 1, "1.2e-01");
+  EXPECT_EXP(2.5, 0, "2e+00");
+  EXPECT_EXP(4503599627370495.5, 0, "5e+15");
+  EXPECT_EXP(99.995, 2, "1.00e+02");
+  EXPECT_EXP(1e-19, 17, "9.99999999999999975e-20");
+  EXPECT_EXP(9.5e-20, 17, "9.50000000000000001e-20");
+  EXPECT_EXP(-123.456, 17, "-1.23456000000000003e+02");
+}
+
+#define EXPECT_EXP_ROUNDED(a, b, halfEven, halfUp, truncate, floor, ceil) { \
+    const char* const expected[] = { halfEven, halfUp, truncate, floor, ceil }; \
+    const ryu_rounding modes[] = { RYU_ROUND_HALF_EVEN, RYU_ROUND_HALF_UP, RYU_ROUND_TRUNCATE, RYU_ROUND_FLOOR, RYU_ROUND_CEIL }; \
+    for (int i = 0; i < 5; ++i) { \
+      char result[2000]; \
+      result[d2exp_rounded_buffered_n(a, b, modes[i], result)] = '\0'; \
+      EXPECT_STREQ(expected[i], result) << "mode " << i; \
+    } \
+  } while (0);
+
+TEST(D2expTest, RoundingModes) {
+  // The expected values are the exact binary values rounded with Python's decimal module.
+  EXPECT_EXP_ROUNDED(2.5, 0,
+    "2e+00", "3e+00", "2e+00", "2e+00", "3e+00");
+  EXPECT_EXP_ROUNDED(-2.5, 0,
+    "-2e+00", "-3e+00", "-2e+00", "-3e+00", "-2e+00");
+  EXPECT_EXP_ROUNDED(-0.125, 1,
+    "-1.2e-01", "-1.3e-01", "-1.2e-01", "-1.3e-01", "-1.2e-01");
+  EXPECT_EXP_ROUNDED(-1.005, 2,
+    "-1.00e+00", "-1.00e+00", "-1.00e+00", "-1.01e+00", "-1.00e+00");
+  EXPECT_EXP_ROUNDED(-2.0, 3,
+    "-2.000e+00", "-2.000e+00", "-2.000e+00", "-2.000e+00", "-2.000e+00");
+  EXPECT_EXP_ROUNDED(9.99e100, 1,
+    "1.0e+101", "1.0e+101", "9.9e+100", "9.9e+100", "1.0e+101");
+  EXPECT_EXP_ROUNDED(-9.99e100, 1,
+    "-1.0e+101", "-1.0e+101", "-9.9e+100", "-1.0e+101", "-9.9e+100");
+  EXPECT_EXP_ROUNDED(ldexp(1.0, -40), 26,
+    "9.09494701772928237915039062e-13",
+    "9.09494701772928237915039063e-13",
+    "9.09494701772928237915039062e-13",
+    "9.09494701772928237915039062e-13",
+    "9.09494701772928237915039063e-13");
+  EXPECT_EXP_ROUNDED(-1.0 / 3, 30,
+    "-3.333333333333333148296162562474e-01",
+    "-3.333333333333333148296162562474e-01",
+    "-3.333333333333333148296162562473e-01",
+    "-3.333333333333333148296162562474e-01",
+    "-3.333333333333333148296162562473e-01");
+  EXPECT_EXP_ROUNDED(5e-324, 0,
+    "5e-324", "5e-324", "4e-324", "4e-324", "5e-324");
+}
+
 TEST(D2expTest, PrintDecimalPoint) {
   // These values exercise each codepath.
   EXPECT_EXP(1e+54, 0, "1e+54"  );
@@ -36037,3 +36155,309 @@ TEST(D2expTest, PrintDecimalPoint) {
   EXPECT_EXP(1e+83, 0, "1e+83"  );
   EXPECT_EXP(1e+83, 1, "1.0e+83");
 }
+
+static std::vector<double> batch_values() {
+  std::vector<double> values = {
+    0.0, -0.0, 1.0, -1.0, NAN, INFINITY, -INFINITY, 0.5, 1.5, 2.5, -0.125, 9.9999999,
+    int64Bits2Double(1), int64Bits2Double(0x7fefffffffffffff), 18446744073709549568.0, 1e-20, 1e+300,
+  };
+  uint64_t x = 0x2545F4914F6CDD1DULL;
+  for (int i = 0; i < 1000; ++i) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    values.push_back(int64Bits2Double(x));
+    // Values like these hit the fast path for small precisions.
+    values.push_back((double) (x % 100000000) / 10000.0 - 5000.0);
+  }
+  return values;
+}
+
+static void expect_batch(int (*batch)(const double*, int, uint32_t, char*, int*),
+  int (*single)(double, uint32_t, char*), const uint32_t precision) {
+  const std::vector<double> values = batch_values();
+  const int count = (int) values.size();
+  std::vector<char> output((311 + precision) * values.size());
+  std::vector<int> offsets(values.size() + 1);
+  const int length = batch(values.data(), count, precision, output.data(), offsets.data());
+  ASSERT_EQ(0, offsets[0]);
+  ASSERT_EQ(length, offsets[count]);
+  std::vector<char> expected(311 + precision);
+  for (int i = 0; i < count; ++i) {
+    const int n = single(values[i], precision, expected.data());
+    ASSERT_EQ(std::string(expected.data(), n), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+  }
+}
+
+TEST(D2fixedTest, Batch) {
+  for (const uint32_t precision : {0u, 1u, 4u, 9u, 10u, 17u, 18u, 40u}) {
+    expect_batch(d2fixed_batch, d2fixed_buffered_n, precision);
+  }
+}
+
+TEST(D2expTest, Batch) {
+  for (const uint32_t precision : {0u, 1u, 4u, 9u, 10u, 17u, 18u, 40u}) {
+    expect_batch(d2exp_batch, d2exp_buffered_n, precision);
+  }
+}
+
+static std::string d2fixed_grouped(const double d, const uint32_t precision, const ryu_separators& separators) {
+  std::vector<char> result(311 + precision + 308);
+  return std::string(result.data(), d2fixed_grouped_buffered_n(d, precision, &separators, result.data()));
+}
+
+TEST(D2fixedTest, Grouped) {
+  const ryu_separators comma = { ',', 3, '.' };
+  const ryu_separators dot = { '.', 3, ',' };
+  EXPECT_EQ("1,234,567.89", d2fixed_grouped(1234567.891, 2, comma));
+  EXPECT_EQ("1.234.567,89", d2fixed_grouped(1234567.891, 2, dot));
+  EXPECT_EQ("-123.457", d2fixed_grouped(-123456.7, 0, dot));
+  EXPECT_EQ("0,5", d2fixed_grouped(0.5, 1, dot));
+  EXPECT_EQ("-0,000", d2fixed_grouped(-0.0, 3, dot));
+  EXPECT_EQ("999", d2fixed_grouped(999.0, 0, comma));
+  EXPECT_EQ("1,000", d2fixed_grouped(1000.0, 0, comma));
+  EXPECT_EQ("Infinity", d2fixed_grouped(INFINITY, 2, comma));
+  // Other group sizes, and no grouping.
+  EXPECT_EQ("12'3456'7890.1", d2fixed_grouped(1234567890.125, 1, { '\'', 4, '.' }));
+  EXPECT_EQ("1234567,125", d2fixed_grouped(1234567.125, 3, { '\0', 0, ',' }));
+  EXPECT_EQ("1234567.125", d2fixed_grouped(1234567.125, 3, { ',', 0, '.' }));
+  EXPECT_EQ("1000000000000000043845843045076197354634047651840", d2fixed_grouped(1e48, 0, { ',', 0, '.' }));
+  EXPECT_EQ("1000.0", d2fixed_grouped(999.96, 1, { ',', 0, '.' }));
+  // The general path, for larger precisions and values.
+  EXPECT_EQ("1,234,567.891000000061467289924621582031250000",
+    d2fixed_grouped(1234567.891, 36, comma));
+  EXPECT_EQ("1,000,000,000,000,000,043,845,843,045,076,197,354,634,047,651,840", d2fixed_grouped(1e48, 0, comma));
+  EXPECT_EQ("1,208,925,819,614,629,174,706,176.00", d2fixed_grouped(1208925819614629174706176.0, 2, comma));
+}
+
+TEST(D2fixedTest, GroupedCarry) {
+  const ryu_separators comma = { ',', 3, '.' };
+  // Rounding up carries across group separators, and may add a digit and a group.
+  EXPECT_EQ("2,000", d2fixed_grouped(1999.5, 0, comma));
+  EXPECT_EQ("1,000", d2fixed_grouped(999.5, 0, comma));
+  EXPECT_EQ("1,000.0", d2fixed_grouped(999.96, 1, comma));
+  EXPECT_EQ("-1,000,000.0", d2fixed_grouped(-999999.96, 1, comma));
+  EXPECT_EQ("100,000.00", d2fixed_grouped(99999.999, 2, comma));
+  EXPECT_EQ("1.000,0", d2fixed_grouped(999.96, 1, { '.', 3, ',' }));
+}
+
+TEST(D2fixedTest, GroupedMatchesPlain) {
+  const ryu_separators separators[] = { { ',', 3, '.' }, { ' ', 1, ',' }, { '_', 4, '.' } };
+  char expected[2000];
+  for (const double d : batch_values()) {
+    for (const uint32_t precision : {0u, 2u, 17u, 18u, 40u}) {
+      const int n = d2fixed_buffered_n(d, precision, expected);
+      for (const ryu_separators& s : separators) {
+        std::string plain = d2fixed_grouped(d, precision, s);
+        plain.erase(std::remove(plain.begin(), plain.end(), s.group_char), plain.end());
+        std::replace(plain.begin(), plain.end(), s.decimal_char, '.');
+        ASSERT_EQ(std::string(expected, n), plain);
+      }
+    }
+  }
+}
+
+#define EXPECT_GENERAL(a, b, c, d) { char* result = d2general(a, b, c); EXPECT_STREQ(d, result); free(result); } while (0);
+
+TEST(D2generalTest, Basic) {
+  EXPECT_GENERAL(0.0, 6, 0, "0");
+  EXPECT_GENERAL(-0.0, 6, 0, "-0");
+  EXPECT_GENERAL(1.0, 6, 0, "1");
+  EXPECT_GENERAL(123.456, 6, 0, "123.456");
+  EXPECT_GENERAL(-123.456, 2, 0, "-1.2e+02");
+  EXPECT_GENERAL(0.1, 17, 0, "0.10000000000000001");
+  EXPECT_GENERAL(1729.0, 0, 0, "2e+03");
+  EXPECT_GENERAL(1e100, 6, 0, "1e+100");
+  EXPECT_GENERAL(5e-324, 3, 0, "4.94e-324");
+  EXPECT_GENERAL(1.7976931348623157e308, 17, 0, "1.7976931348623157e+308");
+}
+
+TEST(D2generalTest, Special) {
+  EXPECT_GENERAL(INFINITY, 6, 0, "Infinity");
+  EXPECT_GENERAL(-INFINITY, 6, RYU_ALTERNATE_FORM, "-Infinity");
+  EXPECT_GENERAL(-INFINITY, 0, 0, "-Infinity");
+  EXPECT_GENERAL(NAN, 6, 0, "nan");
+}
+
+TEST(D2generalTest, ExponentThreshold) {
+  // Fixed notation for exponents from -4 up to precision - 1.
+  EXPECT_GENERAL(0.0001, 6, 0, "0.0001");
+  EXPECT_GENERAL(0.00001, 6, 0, "1e-05");
+  EXPECT_GENERAL(0.000123456789, 6, 0, "0.000123457");
+  EXPECT_GENERAL(123456.0, 6, 0, "123456");
+  EXPECT_GENERAL(1234567.0, 6, 0, "1.23457e+06");
+  EXPECT_GENERAL(999999.0, 6, 0, "999999");
+  // The exponent is the one after rounding.
+  EXPECT_GENERAL(999999.5, 6, 0, "1e+06");
+  EXPECT_GENERAL(0.000099999, 3, 0, "0.0001");
+  EXPECT_GENERAL(9.5, 1, 0, "1e+01");
+}
+
+TEST(D2generalTest, TrailingZeros) {
+  EXPECT_GENERAL(1.5, 6, 0, "1.5");
+  EXPECT_GENERAL(100.0, 6, 0, "100");
+  EXPECT_GENERAL(1e20, 6, 0, "1e+20");
+  EXPECT_GENERAL(1.25e20, 6, 0, "1.25e+20");
+  EXPECT_GENERAL(0.5, 6, 0, "0.5");
+}
+
+TEST(D2generalTest, AlternateForm) {
+  EXPECT_GENERAL(0.0, 6, RYU_ALTERNATE_FORM, "0.00000");
+  EXPECT_GENERAL(1.5, 6, RYU_ALTERNATE_FORM, "1.50000");
+  EXPECT_GENERAL(100.0, 3, RYU_ALTERNATE_FORM, "100.");
+  EXPECT_GENERAL(100.0, 1, RYU_ALTERNATE_FORM, "1.e+02");
+  EXPECT_GENERAL(3.0, 0, RYU_ALTERNATE_FORM, "3.");
+  EXPECT_GENERAL(0.0001, 6, RYU_ALTERNATE_FORM, "0.000100000");
+  EXPECT_GENERAL(1e20, 6, RYU_ALTERNATE_FORM, "1.00000e+20");
+  // The C standard requires the trailing zero here; some printf implementations drop it when the
+  // rounding carries into a new digit.
+  EXPECT_GENERAL(99.96, 2, RYU_ALTERNATE_FORM, "1.0e+02");
+}
+
+#define EXPECT_ENG(a, b, c, d) { char* result = d2eng(a, b, c); EXPECT_STREQ(d, result); free(result); } while (0);
+
+TEST(D2engTest, Basic) {
+  EXPECT_ENG(0.0, 3, 0, "0.00e+00");
+  EXPECT_ENG(-0.0, 1, 0, "-0e+00");
+  EXPECT_ENG(1.0, 4, 0, "1.000e+00");
+  EXPECT_ENG(12.5, 3, 0, "12.5e+00");
+  EXPECT_ENG(125.0, 3, 0, "125e+00");
+  EXPECT_ENG(3.3e6, 4, 0, "3.300e+06");
+  EXPECT_ENG(12500.0, 3, 0, "12.5e+03");
+  EXPECT_ENG(-0.00125, 2, 0, "-1.3e-03");
+  EXPECT_ENG(1.5e-7, 3, 0, "150e-09");
+  EXPECT_ENG(1.7976931348623157e308, 17, 0, "179.76931348623157e+306");
+  EXPECT_ENG(int64Bits2Double(1), 1, 0, "5e-324");
+  EXPECT_ENG(1e-323, 3, 0, "9.88e-324");
+  EXPECT_ENG(123456789.0, 0, 0, "100e+06");
+}
+
+TEST(D2engTest, Special) {
+  EXPECT_ENG(INFINITY, 6, 0, "Infinity");
+  EXPECT_ENG(-INFINITY, 6, RYU_SI_PREFIX, "-Infinity");
+  EXPECT_ENG(NAN, 6, RYU_SI_PREFIX, "nan");
+}
+
+TEST(D2engTest, PaddedLeadingDigits) {
+  // Fewer significant digits than digits before the decimal point.
+  EXPECT_ENG(12345.0, 1, 0, "10e+03");
+  EXPECT_ENG(12345.0, 2, 0, "12e+03");
+  EXPECT_ENG(123456.0, 1, 0, "100e+03");
+  EXPECT_ENG(123456.0, 2, 0, "120e+03");
+  EXPECT_ENG(123456.0, 3, 0, "123e+03");
+  EXPECT_ENG(123456.0, 4, 0, "123.5e+03");
+}
+
+TEST(D2engTest, Carrying) {
+  // Rounding up can move the exponent to the next multiple of 3.
+  EXPECT_ENG(999.5, 3, 0, "1.00e+03");
+  EXPECT_ENG(999.4, 3, 0, "999e+00");
+  EXPECT_ENG(99.96, 3, 0, "100e+00");
+  EXPECT_ENG(9.9996, 4, 0, "10.00e+00");
+  EXPECT_ENG(-999999.5, 6, RYU_SI_PREFIX, "-1.00000M");
+  EXPECT_ENG(9.5e-7, 1, RYU_SI_PREFIX, "1\xC2\xB5");
+  // Large precisions and values go through the general path.
+  EXPECT_ENG(999.5, 40, 0, "999.5000000000000000000000000000000000000e+00");
+  EXPECT_ENG(1e23, 15, 0, "100.000000000000e+21");
+}
+
+TEST(D2engTest, SiPrefix) {
+  EXPECT_ENG(12500.0, 3, RYU_SI_PREFIX, "12.5k");
+  EXPECT_ENG(3.3e6, 4, RYU_SI_PREFIX, "3.300M");
+  EXPECT_ENG(1.0, 2, RYU_SI_PREFIX, "1.0");
+  EXPECT_ENG(0.0, 2, RYU_SI_PREFIX, "0.0");
+  EXPECT_ENG(0.0125, 3, RYU_SI_PREFIX, "12.5m");
+  EXPECT_ENG(3.3e-6, 2, RYU_SI_PREFIX, "3.3\xC2\xB5");
+  EXPECT_ENG(4.7e-9, 2, RYU_SI_PREFIX, "4.7n");
+  EXPECT_ENG(-2.2e-12, 2, RYU_SI_PREFIX, "-2.2p");
+  EXPECT_ENG(6.02214076e23, 4, RYU_SI_PREFIX, "602.2Z");
+  EXPECT_ENG(1e-30, 1, RYU_SI_PREFIX, "1q");
+  EXPECT_ENG(1e-27, 1, RYU_SI_PREFIX, "1r");
+  EXPECT_ENG(1e30, 1, RYU_SI_PREFIX, "1Q");
+  EXPECT_ENG(1e27, 1, RYU_SI_PREFIX, "1R");
+  // Outside of the range of the prefixes.
+  EXPECT_ENG(1e33, 1, RYU_SI_PREFIX, "1e+33");
+  EXPECT_ENG(1e-31, 2, RYU_SI_PREFIX, "100e-33");
+}
+
+static std::string stream_all(ryu_stream* const stream, const int chunk) {
+  std::string result;
+  char buffer[64];
+  int length;
+  while ((length = ryu_stream_next(stream, buffer, chunk)) > 0) {
+    EXPECT_LE(length, chunk);
+    result.append(buffer, length);
+  }
+  return result;
+}
+
+static void expect_stream(const double d, const uint32_t precision) {
+  char expected[2000];
+  const int fixedLength = d2fixed_buffered_n(d, precision, expected);
+  for (const int chunk : { 1, 2, 7, 9, 10, 64 }) {
+    ryu_stream stream;
+    d2fixed_stream_init(&stream, d, precision);
+    EXPECT_EQ(std::string(expected, fixedLength), stream_all(&stream, chunk)) << d << " " << precision;
+  }
+  const int expLength = d2exp_buffered_n(d, precision, expected);
+  for (const int chunk : { 1, 2, 7, 9, 10, 64 }) {
+    ryu_stream stream;
+    d2exp_stream_init(&stream, d, precision);
+    EXPECT_EQ(std::string(expected, expLength), stream_all(&stream, chunk)) << d << " " << precision;
+  }
+}
+
+TEST(RyuStreamTest, Basic) {
+  ryu_stream stream;
+  d2fixed_stream_init(&stream, -123.456, 2);
+  EXPECT_EQ("-123.46", stream_all(&stream, 3));
+  d2exp_stream_init(&stream, 123.456, 3);
+  EXPECT_EQ("1.235e+02", stream_all(&stream, 4));
+  // Once the output is complete, the stream keeps returning 0.
+  char buffer[4];
+  EXPECT_EQ(0, ryu_stream_next(&stream, buffer, 4));
+}
+
+TEST(RyuStreamTest, Special) {
+  expect_stream(0.0, 0);
+  expect_stream(-0.0, 5);
+  expect_stream(INFINITY, 5);
+  expect_stream(-INFINITY, 5);
+  expect_stream(NAN, 5);
+}
+
+TEST(RyuStreamTest, Carrying) {
+  // Rounding up turns trailing 9s into 0s, possibly all the way to a new first digit.
+  expect_stream(9.9999999999, 4);
+  expect_stream(0.99999, 2);
+  expect_stream(-999999999.5, 0);
+  expect_stream(9.5, 0);
+  expect_stream(0.5, 0);
+  expect_stream(1.5, 0);
+  expect_stream(2.5, 0);
+  expect_stream(999999999999999999999999999999.0, 3);
+  expect_stream(0.0000999999999, 5);
+}
+
+TEST(RyuStreamTest, LargePrecision) {
+  expect_stream(5e-324, 1100);
+  expect_stream(1.7976931348623157e308, 500);
+  expect_stream(0.1, 1000);
+  expect_stream(1234567890123456789.0, 100);
+  expect_stream(2.2250738585072014e-308, 800);
+}
+
+TEST(RyuStreamTest, AllPowersOfTen) {
+  for (const auto& tc : all_powers_of_ten) {
+    expect_stream(tc.value, 20);
+  }
+}
+
+TEST(RyuStreamTest, StopEarly) {
+  ryu_stream stream;
+  d2fixed_stream_init(&stream, 1.0 / 3.0, 1000);
+  char buffer[16];
+  ASSERT_EQ(16, ryu_stream_next(&stream, buffer, 16));
+  EXPECT_EQ("0.33333333333333", std::string(buffer, 16));
+}
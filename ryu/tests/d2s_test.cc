@@ -16,6 +16,8 @@
 // KIND, either express or implied.
 
 #include <math.h>
+#include <string>
+#include <vector>
 
 #include "ryu/ryu.h"
 #include "third_party/gtest/gtest.h"
@@ -34,6 +36,12 @@ static double ieeeParts2Double(const bool sign, const uint32_t ieeeExponent, con
 
 #define ASSERT_D2S(a, b) { char* result = d2s(b); ASSERT_STREQ(a, result); free(result); } while (0);
 
+#define ASSERT_D2S_ECMASCRIPT(a, b) { char result[25]; const int result_len = d2s_ecmascript_buffered_n(b, result); ASSERT_EQ(std::string(a), std::string(result, result_len)); } while (0);
+
+#define ASSERT_D2S_FORMAT(a, format, b) { char result[24]; const int result_len = d2s_format_buffered_n(b, &format, result); ASSERT_EQ(std::string(a), std::string(result, result_len)); } while (0);
+
+#define ASSERT_D2S_FIXED(a, b) { char result[327]; const int result_len = d2s_fixed_shortest_buffered_n(b, result); ASSERT_EQ(std::string(a), std::string(result, result_len)); } while (0);
+
 TEST(D2sTest, Basic) {
   ASSERT_D2S("0E0", 0.0);
   ASSERT_D2S("-0E0", -0.0);
@@ -248,3 +256,205 @@ TEST(D2sTest, SmallIntegers) {
   ASSERT_D2S("5.49755813888E14", 549755813888.0e+3);
   ASSERT_D2S("8.796093022208E15", 8796093022208.0e+3);
 }
+
+TEST(D2sTest, Batch) {
+  std::vector<double> values = {
+    0.0, -0.0, 1.0, -1.0, NAN, INFINITY, -INFINITY, 1.2345678,
+    int64Bits2Double(1), int64Bits2Double(0x7fefffffffffffff), 2.98023223876953125E-8,
+    9007199254740991.0, 1.0e+15 + 1.0e+14,
+  };
+  uint64_t x = 0x2545F4914F6CDD1DULL;
+  for (int i = 0; i < 1000; ++i) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    values.push_back(int64Bits2Double(x));
+  }
+  // Values with few significant digits take different paths in d2d than random bit patterns.
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(i / 1000.0);
+    values.push_back(i * 1.0e+20);
+  }
+
+  const int count = (int) values.size();
+  std::vector<char> output(24 * values.size());
+  std::vector<int> offsets(values.size() + 1);
+  const int length = d2s_batch(values.data(), count, output.data(), offsets.data());
+  ASSERT_EQ(0, offsets[0]);
+  ASSERT_EQ(length, offsets[count]);
+  for (int i = 0; i < count; ++i) {
+    char expected[25];
+    const int n = d2s_buffered_n(values[i], expected);
+    ASSERT_EQ(std::string(expected, n), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+  }
+}
+
+TEST(D2sTest, Slack) {
+  std::vector<double> values = {
+    0.0, -0.0, 1.0, -1.0, NAN, INFINITY, -INFINITY, 1.2345678, -1.0e-7, 1.0e+100,
+    int64Bits2Double(1), int64Bits2Double(0x7fefffffffffffff), -int64Bits2Double(0x7fefffffffffffff),
+  };
+  uint64_t x = 0x2545F4914F6CDD1DULL;
+  for (int i = 0; i < 1000; ++i) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    values.push_back(int64Bits2Double(x));
+    values.push_back(i / 1000.0);
+  }
+  for (const double value : values) {
+    char expected[25];
+    const int n = d2s_buffered_n(value, expected);
+    char result[33];
+    result[32] = 'x';
+    ASSERT_EQ(std::string(expected, n), std::string(result, d2s_slack_buffered_n(value, result)));
+    ASSERT_EQ('x', result[32]);
+  }
+}
+
+TEST(D2sTest, FixedShortest) {
+  ASSERT_D2S_FIXED("0", 0.0);
+  ASSERT_D2S_FIXED("-0", -0.0);
+  ASSERT_D2S_FIXED("NaN", NAN);
+  ASSERT_D2S_FIXED("Infinity", INFINITY);
+  ASSERT_D2S_FIXED("-Infinity", -INFINITY);
+  ASSERT_D2S_FIXED("1", 1.0);
+  ASSERT_D2S_FIXED("-1", -1.0);
+  ASSERT_D2S_FIXED("123.45", 123.45);
+  ASSERT_D2S_FIXED("-123.45", -123.45);
+  ASSERT_D2S_FIXED("0.3", 0.3);
+  ASSERT_D2S_FIXED("0.0012", 0.0012);
+  ASSERT_D2S_FIXED("1200", 1200.0);
+  ASSERT_D2S_FIXED("1.2345678901234567", 1.2345678901234567);
+  ASSERT_D2S_FIXED("12345678901234568", 12345678901234568.0);
+  ASSERT_D2S_FIXED("9007199254740991", 9007199254740991.0);
+  ASSERT_D2S_FIXED("100000000000000000000", 1.0e20);
+  ASSERT_D2S_FIXED("0.000000000000000000001", 1.0e-21);
+  ASSERT_D2S_FIXED("0.000000029802322387695312", 2.98023223876953125E-8);
+  ASSERT_D2S_FIXED(("17976931348623157" + std::string(292, '0')).c_str(), int64Bits2Double(0x7fefffffffffffff));
+  ASSERT_D2S_FIXED(("-0." + std::string(323, '0') + "5").c_str(), -int64Bits2Double(1));
+}
+
+static std::string d2s_fixed_grouped(const double f, const ryu_separators& separators) {
+  char result[327 + 308];
+  return std::string(result, d2s_fixed_shortest_grouped_buffered_n(f, &separators, result));
+}
+
+TEST(D2sTest, FixedShortestGrouped) {
+  const ryu_separators comma = { ',', 3, '.' };
+  const ryu_separators dot = { '.', 3, ',' };
+  EXPECT_EQ("0", d2s_fixed_grouped(0.0, comma));
+  EXPECT_EQ("-0", d2s_fixed_grouped(-0.0, comma));
+  EXPECT_EQ("NaN", d2s_fixed_grouped(NAN, comma));
+  EXPECT_EQ("-Infinity", d2s_fixed_grouped(-INFINITY, comma));
+  EXPECT_EQ("1", d2s_fixed_grouped(1.0, comma));
+  EXPECT_EQ("999", d2s_fixed_grouped(999.0, comma));
+  EXPECT_EQ("1,000", d2s_fixed_grouped(1000.0, comma));
+  EXPECT_EQ("1,234,567.5", d2s_fixed_grouped(1234567.5, comma));
+  EXPECT_EQ("-1.234.567,5", d2s_fixed_grouped(-1234567.5, dot));
+  EXPECT_EQ("0,0012", d2s_fixed_grouped(0.0012, dot));
+  EXPECT_EQ("123,45", d2s_fixed_grouped(123.45, dot));
+  EXPECT_EQ("12,345,678,901,234,568", d2s_fixed_grouped(12345678901234568.0, comma));
+  EXPECT_EQ("100,000,000,000,000,000,000", d2s_fixed_grouped(1.0e20, comma));
+  EXPECT_EQ("1 0 0 0 0", d2s_fixed_grouped(1.0e4, { ' ', 1, '.' }));
+  EXPECT_EQ("1234567,5", d2s_fixed_grouped(1234567.5, { '\0', 0, ',' }));
+  EXPECT_EQ("1234567.5", d2s_fixed_grouped(1234567.5, { ',', 0, '.' }));
+  EXPECT_EQ("100000000000000000000", d2s_fixed_grouped(1.0e20, { ',', 0, '.' }));
+  std::string max = "179";
+  for (int i = 0; i < 102; ++i) {
+    max += i < 5 ? "," + std::string("769313486231570").substr(3 * i, 3) : ",000";
+  }
+  EXPECT_EQ(max, d2s_fixed_grouped(int64Bits2Double(0x7fefffffffffffff), comma));
+}
+
+TEST(D2sTest, ECMAScript) {
+  ASSERT_D2S_ECMASCRIPT("0", 0.0);
+  ASSERT_D2S_ECMASCRIPT("0", -0.0);
+  ASSERT_D2S_ECMASCRIPT("NaN", NAN);
+  ASSERT_D2S_ECMASCRIPT("Infinity", INFINITY);
+  ASSERT_D2S_ECMASCRIPT("-Infinity", -INFINITY);
+  ASSERT_D2S_ECMASCRIPT("1", 1.0);
+  ASSERT_D2S_ECMASCRIPT("-123.45", -123.45);
+  ASSERT_D2S_ECMASCRIPT("0.1", 0.1);
+  ASSERT_D2S_ECMASCRIPT("100", 100.0);
+  ASSERT_D2S_ECMASCRIPT("0.000001", 1.0e-6);
+  ASSERT_D2S_ECMASCRIPT("1e-7", 1.0e-7);
+  ASSERT_D2S_ECMASCRIPT("1.23e-7", 1.23e-7);
+  ASSERT_D2S_ECMASCRIPT("0.00000123", 1.23e-6);
+  ASSERT_D2S_ECMASCRIPT("100000000000000000000", 1.0e20);
+  ASSERT_D2S_ECMASCRIPT("999999999999999900000", 999999999999999900000.0);
+  ASSERT_D2S_ECMASCRIPT("1e+21", 1.0e21);
+  ASSERT_D2S_ECMASCRIPT("-1.5e+21", -1.5e21);
+  ASSERT_D2S_ECMASCRIPT("1.7976931348623157e+308", int64Bits2Double(0x7fefffffffffffff));
+  ASSERT_D2S_ECMASCRIPT("5e-324", int64Bits2Double(1));
+  ASSERT_D2S_ECMASCRIPT("-1.2345678901234568e-300", -1.2345678901234568e-300);
+}
+
+TEST(D2sTest, Format) {
+  const ryu_format plain = { 'E', false, 1, false, "Infinity", "NaN" };
+  ASSERT_D2S_FORMAT("0E0", plain, 0.0);
+  ASSERT_D2S_FORMAT("-1.2345E2", plain, -123.45);
+  uint64_t x = 0x2545F4914F6CDD1DULL;
+  for (int i = 0; i < 1000; ++i) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    char expected[25];
+    const int n = d2s_buffered_n(int64Bits2Double(x), expected);
+    ASSERT_D2S_FORMAT(std::string(expected, n), plain, int64Bits2Double(x));
+  }
+
+  const ryu_format printf_like = { 'e', true, 2, false, "inf", "nan" };
+  ASSERT_D2S_FORMAT("0e+00", printf_like, 0.0);
+  ASSERT_D2S_FORMAT("-0e+00", printf_like, -0.0);
+  ASSERT_D2S_FORMAT("1.2345e+02", printf_like, 123.45);
+  ASSERT_D2S_FORMAT("1e-07", printf_like, 1.0e-7);
+  ASSERT_D2S_FORMAT("1.7976931348623157e+308", printf_like, int64Bits2Double(0x7fefffffffffffff));
+  ASSERT_D2S_FORMAT("-5e-324", printf_like, -int64Bits2Double(1));
+  ASSERT_D2S_FORMAT("inf", printf_like, INFINITY);
+  ASSERT_D2S_FORMAT("-inf", printf_like, -INFINITY);
+  ASSERT_D2S_FORMAT("nan", printf_like, NAN);
+
+  const ryu_format padded = { 'E', false, 3, true, "Infinity", "NaN" };
+  ASSERT_D2S_FORMAT("1.0E000", padded, 1.0);
+  ASSERT_D2S_FORMAT("-0.0E000", padded, -0.0);
+  ASSERT_D2S_FORMAT("1.2E001", padded, 12.0);
+  ASSERT_D2S_FORMAT("1.0E-100", padded, 1.0e-100);
+  ASSERT_D2S_FORMAT("-Infinity", padded, -INFINITY);
+}
+
+TEST(D2sTest, DoubleToFd64) {
+  bool sign = false;
+  floating_decimal_64 v;
+  ASSERT_EQ(RYU_FINITE, double_to_fd64(-123.45, &sign, &v));
+  ASSERT_TRUE(sign);
+  ASSERT_EQ(12345u, v.mantissa);
+  ASSERT_EQ(-2, v.exponent);
+
+  // Small integers don't have trailing zeros either.
+  ASSERT_EQ(RYU_FINITE, double_to_fd64(1200.0, &sign, &v));
+  ASSERT_FALSE(sign);
+  ASSERT_EQ(12u, v.mantissa);
+  ASSERT_EQ(2, v.exponent);
+
+  ASSERT_EQ(RYU_FINITE, double_to_fd64(int64Bits2Double(1), &sign, &v));
+  ASSERT_EQ(5u, v.mantissa);
+  ASSERT_EQ(-324, v.exponent);
+
+  ASSERT_EQ(RYU_FINITE, double_to_fd64(int64Bits2Double(0x7fefffffffffffff), &sign, &v));
+  ASSERT_EQ(17976931348623157u, v.mantissa);
+  ASSERT_EQ(292, v.exponent);
+
+  ASSERT_EQ(RYU_ZERO, double_to_fd64(-0.0, &sign, &v));
+  ASSERT_TRUE(sign);
+  ASSERT_EQ(0u, v.mantissa);
+  ASSERT_EQ(0, v.exponent);
+  ASSERT_EQ(RYU_INFINITE, double_to_fd64(-INFINITY, &sign, &v));
+  ASSERT_TRUE(sign);
+  ASSERT_EQ(RYU_INFINITE, double_to_fd64(INFINITY, &sign, &v));
+  ASSERT_FALSE(sign);
+  ASSERT_EQ(RYU_NAN, double_to_fd64(NAN, &sign, &v));
+}
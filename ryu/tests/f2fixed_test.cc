@@ -0,0 +1,113 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+#include "ryu/ryu.h"
+#include "third_party/gtest/gtest.h"
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+#define EXPECT_FIXED(a, b, c) { char* result = f2fixed(a, b); EXPECT_STREQ(c, result); free(result); } while (0);
+#define EXPECT_EXP(a, b, c) { char* result = f2exp(a, b); EXPECT_STREQ(c, result); free(result); } while (0);
+
+// f2fixed and f2exp must match d2fixed and d2exp for the float widened to double.
+static void expectSameAsDouble(const float f, const uint32_t precision) {
+  char* expected = d2fixed(f, precision);
+  char* actual = f2fixed(f, precision);
+  ASSERT_STREQ(expected, actual) << precision;
+  free(expected);
+  free(actual);
+  expected = d2exp(f, precision);
+  actual = f2exp(f, precision);
+  ASSERT_STREQ(expected, actual) << precision;
+  free(expected);
+  free(actual);
+}
+
+TEST(F2fixedTest, Basic) {
+  EXPECT_FIXED(3.14159274f, 5, "3.14159");
+  EXPECT_FIXED(-0.1f, 12, "-0.100000001490");
+  EXPECT_FIXED(16777216.0f, 2, "16777216.00");
+  EXPECT_EXP(3.14159274f, 5, "3.14159e+00");
+  EXPECT_EXP(-0.1f, 12, "-1.000000014901e-01");
+}
+
+TEST(F2fixedTest, Special) {
+  EXPECT_FIXED(0.0f, 3, "0.000");
+  EXPECT_FIXED(-0.0f, 0, "-0");
+  EXPECT_FIXED(INFINITY, 3, "Infinity");
+  EXPECT_FIXED(-INFINITY, 3, "-Infinity");
+  EXPECT_EXP(0.0f, 2, "0.00e+00");
+  EXPECT_EXP(-0.0f, 0, "-0e+00");
+  EXPECT_EXP(INFINITY, 3, "Infinity");
+  EXPECT_EXP(-INFINITY, 0, "-Infinity");
+  EXPECT_EXP(-INFINITY, 1, "-Infinity");
+}
+
+TEST(F2fixedTest, MinMax) {
+  EXPECT_FIXED(int32Bits2Float(0x7f7fffff), 0, "340282346638528859811704183484516925440");
+  EXPECT_EXP(int32Bits2Float(0x7f7fffff), 10, "3.4028234664e+38");
+  EXPECT_EXP(int32Bits2Float(1), 104,
+    "1.401298464324817070923729583289916131280261941876515771757068283889791082685860601486638188362121582031"
+    "25e-45");
+  EXPECT_FIXED(int32Bits2Float(1), 50, "0.00000000000000000000000000000000000000000000140130");
+}
+
+TEST(F2fixedTest, Rounding) {
+  EXPECT_FIXED(0.125f, 2, "0.12");
+  EXPECT_FIXED(0.375f, 2, "0.38");
+  EXPECT_FIXED(2.5f, 0, "2");
+  EXPECT_FIXED(3.5f, 0, "4");
+  EXPECT_FIXED(0.5f, 0, "0");
+  EXPECT_FIXED(9.5f, 0, "10");
+  EXPECT_FIXED(-99.99f, 1, "-100.0");
+  EXPECT_FIXED(0.00999f, 2, "0.01");
+  EXPECT_EXP(9.5f, 0, "1e+01");
+  EXPECT_EXP(-99.99f, 2, "-1.00e+02");
+  EXPECT_EXP(0.125f, 1, "1.2e-01");
+}
+
+TEST(F2fixedTest, AllBinaryExponents) {
+  for (uint32_t exponent = 0; exponent < 255; ++exponent) {
+    for (const uint32_t mantissa : { 0u, 1u, 0x400000u, 0x7fffffu }) {
+      const float f = int32Bits2Float((exponent << 23) | mantissa);
+      for (uint32_t precision = 0; precision < 120; ++precision) {
+        expectSameAsDouble(f, precision);
+      }
+    }
+  }
+}
+
+TEST(F2fixedTest, Random) {
+  std::mt19937 mt32(12345);
+  for (int i = 0; i < 20000; ++i) {
+    const float f = int32Bits2Float(mt32());
+    if (isnan(f)) {
+      continue;
+    }
+    expectSameAsDouble(f, mt32() % 60);
+  }
+}
@@ -0,0 +1,190 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Checks f2s for all 2^32 floats, or a range of them, on all cores. For each value, this checks
+// that s2f parses the output of f2s back to the same value, and that the output is identical to
+// that of the generic 128-bit implementation, which means that it has the same (shortest) length
+// and the same digits.
+//
+// The range is split into chunks of 2^16 values. Each thread repeatedly claims the next unclaimed
+// chunk, so threads that get faster chunks (e.g., NaNs) simply process more of them.
+
+#include <atomic>
+#include <chrono>
+#include <inttypes.h>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#include "ryu/ryu_generic_128.h"
+
+using namespace std::chrono;
+
+static constexpr uint64_t CHUNK_SIZE = 1 << 16;
+// Print at most this many mismatches.
+static constexpr uint64_t MAX_REPORTED = 100;
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static uint32_t float2Int32Bits(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(float));
+  return bits;
+}
+
+struct exhaustive_state {
+  uint64_t begin = 0;
+  uint64_t end = 1ull << 32;
+  std::atomic<uint64_t> nextChunk{0};
+  std::atomic<uint64_t> done{0};
+  std::atomic<uint64_t> mismatches{0};
+  std::mutex outputMutex;
+};
+
+static void report(exhaustive_state& state, const uint32_t bits, const char* const what,
+  const char* const actual, const char* const expected) {
+  if (state.mismatches.fetch_add(1) < MAX_REPORTED) {
+    std::lock_guard<std::mutex> lock(state.outputMutex);
+    printf("%08" PRIX32 ": %s: %s, expected %s\n", bits, what, actual, expected);
+  }
+}
+
+static void check(exhaustive_state& state, const uint32_t bits) {
+  const float f = int32Bits2Float(bits);
+  char actual[16];
+  const int length = f2s_buffered_n(f, actual);
+  actual[length] = '\0';
+
+  char expected[53];
+  const int expectedLength = generic_to_chars(float_to_fd128(f), expected);
+  expected[expectedLength] = '\0';
+  if (length != expectedLength || memcmp(actual, expected, length) != 0) {
+    report(state, bits, "f2s", actual, expected);
+  }
+
+  if (((bits >> 23) & 0xff) == 0xff) {
+    // s2f doesn't parse NaN and Infinity.
+    return;
+  }
+  float parsed;
+  const enum Status status = s2f_n(actual, length, &parsed);
+  if (status != SUCCESS || float2Int32Bits(parsed) != bits) {
+    char roundTrip[16];
+    if (status == SUCCESS) {
+      snprintf(roundTrip, sizeof(roundTrip), "%08" PRIX32, float2Int32Bits(parsed));
+    } else {
+      snprintf(roundTrip, sizeof(roundTrip), "status %d", (int) status);
+    }
+    char original[16];
+    snprintf(original, sizeof(original), "%08" PRIX32, bits);
+    report(state, bits, "s2f(f2s)", roundTrip, original);
+  }
+}
+
+static void run(exhaustive_state& state) {
+  for (;;) {
+    const uint64_t chunkBegin = state.begin + state.nextChunk.fetch_add(1) * CHUNK_SIZE;
+    if (chunkBegin >= state.end) {
+      return;
+    }
+    const uint64_t chunkEnd = chunkBegin + CHUNK_SIZE < state.end ? chunkBegin + CHUNK_SIZE : state.end;
+    for (uint64_t bits = chunkBegin; bits < chunkEnd; ++bits) {
+      check(state, (uint32_t) bits);
+    }
+    state.done.fetch_add(chunkEnd - chunkBegin);
+  }
+}
+
+static void fail(const char* const arg) {
+  printf("Unrecognized option '%s'.\n", arg);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+  exhaustive_state state;
+  int threads = (int) std::thread::hardware_concurrency();
+  for (int i = 1; i < argc; ++i) {
+    const char* const arg = argv[i];
+    if (strncmp(arg, "-threads=", 9) == 0) {
+      if (sscanf(arg, "-threads=%i", &threads) != 1 || threads < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-begin=", 7) == 0) {
+      if (sscanf(arg, "-begin=%" SCNx64, &state.begin) != 1 || state.begin > (1ull << 32)) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-end=", 5) == 0) {
+      if (sscanf(arg, "-end=%" SCNx64, &state.end) != 1 || state.end > (1ull << 32)) {
+        fail(arg);
+      }
+    } else {
+      fail(arg);
+    }
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+  if (state.begin > state.end) {
+    state.begin = state.end;
+  }
+  const uint64_t total = state.end - state.begin;
+  printf("Checking %" PRIu64 " floats [%08" PRIX64 ", %08" PRIX64 ") on %d threads\n",
+    total, state.begin, state.end, threads);
+
+  const auto start = steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back(run, std::ref(state));
+  }
+  auto lastReport = start;
+  for (;;) {
+    std::this_thread::sleep_for(milliseconds(100));
+    const uint64_t done = state.done.load();
+    if (done == total) {
+      break;
+    }
+    const auto now = steady_clock::now();
+    if (now - lastReport < seconds(5)) {
+      continue;
+    }
+    lastReport = now;
+    const double elapsed = duration_cast<milliseconds>(now - start).count() / 1000.0;
+    const double throughput = done / elapsed;
+    std::lock_guard<std::mutex> lock(state.outputMutex);
+    printf("%6.2f%% done, %.1f M floats/s, %" PRIu64 " mismatches, %.0f s remaining\n",
+      100.0 * done / total, throughput / 1e6, state.mismatches.load(), (total - done) / throughput);
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  const double elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count() / 1000.0;
+  const uint64_t mismatches = state.mismatches.load();
+  printf("Checked %" PRIu64 " floats in %.1f s (%.1f M floats/s): %" PRIu64 " mismatches\n",
+    total, elapsed, total / elapsed / 1e6, mismatches);
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -16,6 +16,8 @@
 // KIND, either express or implied.
 
 #include <math.h>
+#include <string>
+#include <vector>
 
 #include "ryu/ryu.h"
 #include "third_party/gtest/gtest.h"
@@ -28,6 +30,10 @@ static float int32Bits2Float(uint32_t bits) {
 
 #define ASSERT_F2S(a, b) { char* result = f2s(b); ASSERT_STREQ(a, result); free(result); } while (0);
 
+#define ASSERT_F2S_FORMAT(a, format, b) { char result[16]; const int result_len = f2s_format_buffered_n(b, &format, result); ASSERT_EQ(std::string(a), std::string(result, result_len)); } while (0);
+
+#define ASSERT_F2S_FIXED(a, b) { char result[48]; const int result_len = f2s_fixed_shortest_buffered_n(b, result); ASSERT_EQ(std::string(a), std::string(result, result_len)); } while (0);
+
 TEST(F2sTest, Basic) {
   ASSERT_F2S("0E0", 0.0);
   ASSERT_F2S("-0E0", -0.0);
@@ -128,3 +134,114 @@ TEST(F2sTest, OutputLength) {
   ASSERT_F2S("1.2345678E0", 1.2345678f);
   ASSERT_F2S("1.23456735E-36", 1.23456735E-36f);
 }
+
+TEST(F2sTest, Batch) {
+  std::vector<float> values = {
+    0.0f, -0.0f, 1.0f, -1.0f, NAN, INFINITY, -INFINITY, 1.2345678f,
+    int32Bits2Float(1), int32Bits2Float(0x7f7fffff), 3.4366718e10f, 1.0e+9f, 1.0e-7f,
+  };
+  uint32_t x = 0x2545F491u;
+  for (int i = 0; i < 1000; ++i) {
+    // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    values.push_back(int32Bits2Float(x));
+  }
+  // Values with few significant digits take different paths in f2d than random bit patterns.
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(i / 1000.0f);
+    values.push_back(i * 1.0e+20f);
+  }
+
+  const int count = (int) values.size();
+  std::vector<char> output(15 * values.size());
+  std::vector<int> offsets(values.size() + 1);
+  const int length = f2s_batch(values.data(), count, output.data(), offsets.data());
+  ASSERT_EQ(0, offsets[0]);
+  ASSERT_EQ(length, offsets[count]);
+  for (int i = 0; i < count; ++i) {
+    char expected[16];
+    const int n = f2s_buffered_n(values[i], expected);
+    ASSERT_EQ(std::string(expected, n), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+  }
+}
+
+TEST(F2sTest, FixedShortest) {
+  ASSERT_F2S_FIXED("0", 0.0f);
+  ASSERT_F2S_FIXED("-0", -0.0f);
+  ASSERT_F2S_FIXED("NaN", NAN);
+  ASSERT_F2S_FIXED("Infinity", INFINITY);
+  ASSERT_F2S_FIXED("-Infinity", -INFINITY);
+  ASSERT_F2S_FIXED("1", 1.0f);
+  ASSERT_F2S_FIXED("-1", -1.0f);
+  ASSERT_F2S_FIXED("123.45", 123.45f);
+  ASSERT_F2S_FIXED("0.3", 0.3f);
+  ASSERT_F2S_FIXED("0.0012", 0.0012f);
+  ASSERT_F2S_FIXED("1200", 1200.0f);
+  ASSERT_F2S_FIXED("1.2345678", 1.2345678f);
+  ASSERT_F2S_FIXED("123456790", 123456789.0f);
+  ASSERT_F2S_FIXED("340282350000000000000000000000000000000", int32Bits2Float(0x7f7fffff));
+  ASSERT_F2S_FIXED("-0.000000000000000000000000000000000000000000001", -int32Bits2Float(1));
+}
+
+TEST(F2sTest, Format) {
+  const ryu_format plain = { 'E', false, 1, false, "Infinity", "NaN" };
+  ASSERT_F2S_FORMAT("0E0", plain, 0.0f);
+  ASSERT_F2S_FORMAT("-1.2345E2", plain, -123.45f);
+  for (uint32_t i = 0; i < 1000; ++i) {
+    const float f = int32Bits2Float(i * 4294967u);
+    char expected[16];
+    const int n = f2s_buffered_n(f, expected);
+    ASSERT_F2S_FORMAT(std::string(expected, n), plain, f);
+  }
+
+  const ryu_format printf_like = { 'e', true, 2, false, "inf", "nan" };
+  ASSERT_F2S_FORMAT("0e+00", printf_like, 0.0f);
+  ASSERT_F2S_FORMAT("-0e+00", printf_like, -0.0f);
+  ASSERT_F2S_FORMAT("1.2345e+02", printf_like, 123.45f);
+  ASSERT_F2S_FORMAT("1e-07", printf_like, 1.0e-7f);
+  ASSERT_F2S_FORMAT("3.4028235e+38", printf_like, int32Bits2Float(0x7f7fffff));
+  ASSERT_F2S_FORMAT("-1e-45", printf_like, -int32Bits2Float(1));
+  ASSERT_F2S_FORMAT("inf", printf_like, INFINITY);
+  ASSERT_F2S_FORMAT("-inf", printf_like, -INFINITY);
+  ASSERT_F2S_FORMAT("nan", printf_like, NAN);
+
+  const ryu_format padded = { 'E', true, 3, true, "Infinity", "NaN" };
+  ASSERT_F2S_FORMAT("1.0E+000", padded, 1.0f);
+  ASSERT_F2S_FORMAT("-0.0E+000", padded, -0.0f);
+  ASSERT_F2S_FORMAT("-3.4028235E+038", padded, -int32Bits2Float(0x7f7fffff));
+  ASSERT_F2S_FORMAT("-Infinity", padded, -INFINITY);
+}
+
+TEST(F2sTest, FloatToFd32) {
+  bool sign = false;
+  floating_decimal_32 v;
+  ASSERT_EQ(RYU_FINITE, float_to_fd32(-123.45f, &sign, &v));
+  ASSERT_TRUE(sign);
+  ASSERT_EQ(12345u, v.mantissa);
+  ASSERT_EQ(-2, v.exponent);
+
+  ASSERT_EQ(RYU_FINITE, float_to_fd32(1200.0f, &sign, &v));
+  ASSERT_FALSE(sign);
+  ASSERT_EQ(12u, v.mantissa);
+  ASSERT_EQ(2, v.exponent);
+
+  ASSERT_EQ(RYU_FINITE, float_to_fd32(int32Bits2Float(1), &sign, &v));
+  ASSERT_EQ(1u, v.mantissa);
+  ASSERT_EQ(-45, v.exponent);
+
+  ASSERT_EQ(RYU_FINITE, float_to_fd32(int32Bits2Float(0x7f7fffff), &sign, &v));
+  ASSERT_EQ(34028235u, v.mantissa);
+  ASSERT_EQ(31, v.exponent);
+
+  ASSERT_EQ(RYU_ZERO, float_to_fd32(-0.0f, &sign, &v));
+  ASSERT_TRUE(sign);
+  ASSERT_EQ(0u, v.mantissa);
+  ASSERT_EQ(0, v.exponent);
+  ASSERT_EQ(RYU_INFINITE, float_to_fd32(-INFINITY, &sign, &v));
+  ASSERT_TRUE(sign);
+  ASSERT_EQ(RYU_INFINITE, float_to_fd32(INFINITY, &sign, &v));
+  ASSERT_FALSE(sign);
+  ASSERT_EQ(RYU_NAN, float_to_fd32(NAN, &sign, &v));
+}
@@ -0,0 +1,165 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#include "ryu/ryu_generic_128.h"
+#include "third_party/gtest/gtest.h"
+
+static std::string e4m3(const uint8_t bits) {
+  char result[16];
+  const int n = fp8_e4m3_buffered_n(bits, result);
+  return std::string(result, n);
+}
+
+static std::string e5m2(const uint8_t bits) {
+  char result[16];
+  const int n = fp8_e5m2_buffered_n(bits, result);
+  return std::string(result, n);
+}
+
+static std::string generic(const uint32_t bits, const uint32_t mantissaBits, const uint32_t exponentBits) {
+  char result[53];
+  const int n = generic_to_chars(generic_binary_to_decimal(bits, mantissaBits, exponentBits, false), result);
+  return std::string(result, n);
+}
+
+static uint8_t s2e4m3(const char* const buffer, const bool saturate) {
+  uint8_t result = 0;
+  EXPECT_EQ(SUCCESS, s2fp8_e4m3_n(buffer, (int) strlen(buffer), saturate, &result)) << buffer;
+  return result;
+}
+
+static uint8_t s2e5m2(const char* const buffer, const bool saturate) {
+  uint8_t result = 0;
+  EXPECT_EQ(SUCCESS, s2fp8_e5m2_n(buffer, (int) strlen(buffer), saturate, &result)) << buffer;
+  return result;
+}
+
+TEST(Fp8Test, E4M3Table) {
+  for (uint32_t bits = 0; bits < 256; ++bits) {
+    const uint32_t exponent = (bits >> 3) & 15;
+    const uint32_t mantissa = bits & 7;
+    if (exponent == 15 && mantissa == 7) {
+      ASSERT_EQ("NaN", e4m3((uint8_t) bits));
+    } else if (exponent == 15) {
+      // generic_binary_to_decimal treats this exponent as infinity or NaN, so we move the value into
+      // a format with a 5-bit exponent, where it is a normal number with the same neighbors.
+      const uint32_t widened = ((bits & 0x80) << 1) | ((exponent + 8) << 3) | mantissa;
+      ASSERT_EQ(generic(widened, 3, 5), e4m3((uint8_t) bits)) << bits;
+    } else {
+      ASSERT_EQ(generic(bits, 3, 4), e4m3((uint8_t) bits)) << bits;
+    }
+  }
+  ASSERT_EQ("4.5E2", e4m3(0x7e));
+  ASSERT_EQ("2E-3", e4m3(0x01));
+}
+
+TEST(Fp8Test, E5M2Table) {
+  for (uint32_t bits = 0; bits < 256; ++bits) {
+    ASSERT_EQ(generic(bits, 2, 5), e5m2((uint8_t) bits)) << bits;
+  }
+  ASSERT_EQ("6E4", e5m2(0x7b));
+  ASSERT_EQ("-Infinity", e5m2(0xfc));
+  ASSERT_EQ("NaN", e5m2(0x7e));
+}
+
+TEST(Fp8Test, Batch) {
+  // Use odd counts so that the scalar tail runs as well.
+  for (int count = 0; count < 600; count += 37) {
+    std::vector<uint8_t> values(count);
+    for (int i = 0; i < count; ++i) {
+      values[i] = (uint8_t) (i * 97 + count);
+    }
+    std::vector<char> output(9 * count + 7);
+    std::vector<int> offsets(count + 1);
+
+    int length = fp8_e4m3_batch(values.data(), count, output.data(), offsets.data());
+    ASSERT_EQ(0, offsets[0]);
+    ASSERT_EQ(length, offsets[count]);
+    for (int i = 0; i < count; ++i) {
+      ASSERT_EQ(e4m3(values[i]), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+    }
+
+    length = fp8_e5m2_batch(values.data(), count, output.data(), offsets.data());
+    ASSERT_EQ(0, offsets[0]);
+    ASSERT_EQ(length, offsets[count]);
+    for (int i = 0; i < count; ++i) {
+      ASSERT_EQ(e5m2(values[i]), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+    }
+  }
+}
+
+TEST(Fp8Test, RoundTrip) {
+  for (uint32_t bits = 0; bits < 256; ++bits) {
+    const bool e4m3NaN = (bits & 0x7f) == 0x7f;
+    ASSERT_EQ(e4m3NaN ? 0x7f : bits, s2e4m3(e4m3((uint8_t) bits).c_str(), false)) << bits;
+    const bool e5m2NaN = (bits & 0x7f) > 0x7c;
+    ASSERT_EQ(e5m2NaN ? 0x7f : bits, s2e5m2(e5m2((uint8_t) bits).c_str(), false)) << bits;
+  }
+}
+
+TEST(Fp8Test, ParseRounding) {
+  // 2^-10 is halfway between 0 and the smallest subnormal value, 2^-9.
+  ASSERT_EQ(0x00, s2e4m3("0.0009765625", false));
+  ASSERT_EQ(0x01, s2e4m3("0.0009765626", false));
+  ASSERT_EQ(0x80, s2e4m3("-1E-10", false));
+  // 1.0625 is halfway between 1 and 1.125; 1.1875 is halfway between 1.125 and 1.25.
+  ASSERT_EQ(0x38, s2e4m3("1.0625", false));
+  ASSERT_EQ(0x3a, s2e4m3("1.1875", false));
+  ASSERT_EQ(0x3c, s2e5m2("1.125", false));
+  ASSERT_EQ(0x3e, s2e5m2("1.375", false));
+  ASSERT_EQ(0x44, s2e5m2("3.9", false));
+  // These round to 1.125 as a double, but are not halfway between two 8-bit values.
+  ASSERT_EQ(0x3d, s2e5m2("1.1250000000000001", false));
+  ASSERT_EQ(0x3c, s2e5m2("1.1249999999999999", false));
+  ASSERT_EQ(0x3d, s2e5m2("112500000000000001e-17", false));
+  ASSERT_EQ(0x39, s2e4m3("1.06250000000000000001", false));
+  ASSERT_EQ(0x80, s2e4m3("-0.00097656249999999999", false));
+  ASSERT_EQ(0x81, s2e4m3("-0.00097656250000000001", false));
+}
+
+TEST(Fp8Test, ParseOverflow) {
+  // E4M3: the largest value is 448, and 464 is halfway to the next (unused) value 480.
+  ASSERT_EQ(0x7e, s2e4m3("464", false));
+  ASSERT_EQ(0x7f, s2e4m3("464.1", false));
+  ASSERT_EQ(0x7e, s2e4m3("464.1", true));
+  ASSERT_EQ(0xfe, s2e4m3("-1E10", true));
+  ASSERT_EQ(0x7f, s2e4m3("Infinity", false));
+  ASSERT_EQ(0x7e, s2e4m3("Infinity", true));
+  ASSERT_EQ(0xfe, s2e4m3("-Infinity", true));
+
+  // E5M2: the largest value is 57344, and 61440 is halfway to 65536.
+  ASSERT_EQ(0x7b, s2e5m2("61439", false));
+  ASSERT_EQ(0x7c, s2e5m2("61440", false));
+  ASSERT_EQ(0x7b, s2e5m2("61440", true));
+  ASSERT_EQ(0xfc, s2e5m2("-1E300", false));
+  ASSERT_EQ(0xfc, s2e5m2("-Infinity", false));
+  ASSERT_EQ(0xfb, s2e5m2("-Infinity", true));
+  ASSERT_EQ(0x7f, s2e5m2("NaN", true));
+}
+
+TEST(Fp8Test, ParseErrors) {
+  uint8_t result;
+  ASSERT_EQ(INPUT_TOO_SHORT, s2fp8_e4m3_n("", 0, false, &result));
+  ASSERT_EQ(MALFORMED_INPUT, s2fp8_e4m3_n("1x", 2, false, &result));
+  ASSERT_EQ(MALFORMED_INPUT, s2fp8_e5m2_n("Inf", 3, false, &result));
+}
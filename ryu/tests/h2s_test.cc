@@ -0,0 +1,117 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_generic_128.h"
+#include "third_party/gtest/gtest.h"
+
+#define ASSERT_H2S(a, b) { char* result = h2s(b); ASSERT_STREQ(a, result); free(result); } while (0);
+
+#define ASSERT_BF2S(a, b) { char* result = bf2s(b); ASSERT_STREQ(a, result); free(result); } while (0);
+
+static std::string generic16(const uint16_t bits, const uint32_t mantissaBits, const uint32_t exponentBits) {
+  char buffer[53];
+  const int n = generic_to_chars(generic_binary_to_decimal(bits, mantissaBits, exponentBits, false), buffer);
+  return std::string(buffer, n);
+}
+
+TEST(H2sTest, Basic) {
+  ASSERT_H2S("0E0", 0x0000);
+  ASSERT_H2S("-0E0", 0x8000);
+  ASSERT_H2S("1E0", 0x3c00);
+  ASSERT_H2S("-1E0", 0xbc00);
+  ASSERT_H2S("NaN", 0x7e00);
+  ASSERT_H2S("Infinity", 0x7c00);
+  ASSERT_H2S("-Infinity", 0xfc00);
+}
+
+TEST(H2sTest, Values) {
+  // Widening to float and calling f2s prints 3.140625E0 and 9.9951171875E-4.
+  ASSERT_H2S("3.14E0", 0x4248);
+  ASSERT_H2S("1E-3", 0x1419);
+  ASSERT_H2S("6.55E4", 0x7bff);
+  ASSERT_H2S("6.104E-5", 0x0400);
+  ASSERT_H2S("6.1E-5", 0x03ff);
+  ASSERT_H2S("6E-8", 0x0001);
+  ASSERT_H2S("2.048E3", 0x6800);
+}
+
+TEST(H2sTest, Exhaustive) {
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    char result[10];
+    const int n = h2s_buffered_n((uint16_t) bits, result);
+    ASSERT_EQ(generic16((uint16_t) bits, 10, 5), std::string(result, n)) << bits;
+  }
+}
+
+TEST(Bf2sTest, Basic) {
+  ASSERT_BF2S("0E0", 0x0000);
+  ASSERT_BF2S("-0E0", 0x8000);
+  ASSERT_BF2S("1E0", 0x3f80);
+  ASSERT_BF2S("-1E0", 0xbf80);
+  ASSERT_BF2S("NaN", 0x7fc0);
+  ASSERT_BF2S("Infinity", 0x7f80);
+  ASSERT_BF2S("-Infinity", 0xff80);
+}
+
+TEST(Bf2sTest, Values) {
+  // Widening to float and calling f2s prints 3.140625E0 and 3.3895314E38.
+  ASSERT_BF2S("3.14E0", 0x4049);
+  ASSERT_BF2S("3.39E38", 0x7f7f);
+  ASSERT_BF2S("1.18E-38", 0x0080);
+  // 962560, which generic_128 used to print as 9.62E5.
+  ASSERT_BF2S("9.63E5", 0x496b);
+  ASSERT_BF2S("1E-40", 0x0001);
+}
+
+TEST(Bf2sTest, Exhaustive) {
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    char result[10];
+    const int n = bf2s_buffered_n((uint16_t) bits, result);
+    ASSERT_EQ(generic16((uint16_t) bits, 7, 8), std::string(result, n)) << bits;
+  }
+}
+
+TEST(H2sTest, Batch) {
+  std::vector<uint16_t> values(0x10000);
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    values[bits] = (uint16_t) bits;
+  }
+  const int count = (int) values.size();
+  std::vector<char> output(10 * values.size());
+  std::vector<int> offsets(values.size() + 1);
+
+  int length = h2s_batch(values.data(), count, output.data(), offsets.data());
+  ASSERT_EQ(length, offsets[count]);
+  for (int i = 0; i < count; ++i) {
+    char expected[10];
+    const int n = h2s_buffered_n(values[i], expected);
+    ASSERT_EQ(std::string(expected, n), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+  }
+
+  length = bf2s_batch(values.data(), count, output.data(), offsets.data());
+  ASSERT_EQ(length, offsets[count]);
+  for (int i = 0; i < count; ++i) {
+    char expected[10];
+    const int n = bf2s_buffered_n(values[i], expected);
+    ASSERT_EQ(std::string(expected, n), std::string(output.data() + offsets[i], offsets[i + 1] - offsets[i]));
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <string>
+
+#include "ryu/ryu.h"
+#include "third_party/gtest/gtest.h"
+
+static std::string d2sCached(ryu_cache* cache, const double d) {
+  char result[25];
+  const int n = d2s_cached_buffered_n(cache, d, result);
+  return std::string(result, n);
+}
+
+static std::string f2sCached(ryu_cache* cache, const float f) {
+  char result[16];
+  const int n = f2s_cached_buffered_n(cache, f, result);
+  return std::string(result, n);
+}
+
+TEST(RyuCacheTest, HitsAndMisses) {
+  ryu_cache* const cache = ryu_cache_new(16);
+  ASSERT_TRUE(cache != nullptr);
+  ASSERT_EQ("0E0", d2sCached(cache, 0.0));
+  ASSERT_EQ("0E0", d2sCached(cache, 0.0));
+  ASSERT_EQ("-0E0", d2sCached(cache, -0.0));
+  ASSERT_EQ("1.2345E2", d2sCached(cache, 123.45));
+  ASSERT_EQ("1.2345E2", d2sCached(cache, 123.45));
+  // Floats and doubles don't share entries.
+  ASSERT_EQ("1.2345E2", f2sCached(cache, 123.45f));
+  ASSERT_EQ("0E0", f2sCached(cache, 0.0f));
+  ASSERT_EQ("0E0", f2sCached(cache, 0.0f));
+  const ryu_cache_stats stats = ryu_cache_get_stats(cache);
+  ASSERT_EQ(3u, stats.hits);
+  ASSERT_EQ(5u, stats.misses);
+  ryu_cache_free(cache);
+}
+
+TEST(RyuCacheTest, Special) {
+  ryu_cache* const cache = ryu_cache_new(1);
+  ASSERT_TRUE(cache != nullptr);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ("NaN", d2sCached(cache, NAN));
+    ASSERT_EQ("Infinity", d2sCached(cache, INFINITY));
+    ASSERT_EQ("-Infinity", d2sCached(cache, -INFINITY));
+    ASSERT_EQ("NaN", f2sCached(cache, NAN));
+    ASSERT_EQ("-Infinity", f2sCached(cache, -INFINITY));
+  }
+  // Results with 24 characters are not cached.
+  ASSERT_EQ("-2.2250738585072014E-308", d2sCached(cache, -2.2250738585072014E-308));
+  ASSERT_EQ("-2.2250738585072014E-308", d2sCached(cache, -2.2250738585072014E-308));
+  ryu_cache_free(cache);
+}
+
+TEST(RyuCacheTest, MatchesUncached) {
+  ryu_cache* const cache = ryu_cache_new(64);
+  ASSERT_TRUE(cache != nullptr);
+  uint64_t x = 0x2545F4914F6CDD1DULL;
+  for (int i = 0; i < 10000; ++i) {
+    // xorshift64; only use 128 different values so that we get both hits and collisions.
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    const double d = (double) (x % 128) / 8.0 + (double) ((x >> 32) % 2) * 1.0e300;
+    char expected[25];
+    const int n = d2s_buffered_n(d, expected);
+    ASSERT_EQ(std::string(expected, n), d2sCached(cache, d));
+    const float f = (float) d;
+    char expected32[16];
+    const int n32 = f2s_buffered_n(f, expected32);
+    ASSERT_EQ(std::string(expected32, n32), f2sCached(cache, f));
+  }
+  const ryu_cache_stats stats = ryu_cache_get_stats(cache);
+  ASSERT_EQ(20000u, stats.hits + stats.misses);
+  ASSERT_GT(stats.hits, 0u);
+  ryu_cache_free(cache);
+}
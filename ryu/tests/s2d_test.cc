@@ -16,6 +16,8 @@
 // KIND, either express or implied.
 
 #include <math.h>
+#include <string.h>
+#include <string>
 
 #include "ryu/ryu_parse.h"
 #include "third_party/gtest/gtest.h"
@@ -31,7 +33,6 @@ TEST(S2dTest, BadInput) {
   EXPECT_EQ(MALFORMED_INPUT, s2d("1ee1", &value));
   EXPECT_EQ(MALFORMED_INPUT, s2d("1e.1", &value));
   EXPECT_EQ(INPUT_TOO_SHORT, s2d("", &value));
-  EXPECT_EQ(INPUT_TOO_LONG, s2d("123456789012345678", &value));
   EXPECT_EQ(INPUT_TOO_LONG, s2d("1e12345", &value));
 }
 
@@ -96,4 +97,79 @@ TEST(S2dTest, Issue173) {
 	EXPECT_S2D(2.2250738585072012e-308, "2.2250738585072012e-308");
 	EXPECT_S2D(2.2250738585072013e-308, "2.2250738585072013e-308");
 	EXPECT_S2D(2.2250738585072014e-308, "2.2250738585072014e-308");
-}
\ No newline at end of file
+}
+
+TEST(S2dTest, LongInputs) {
+  EXPECT_S2D(123456789012345678.0, "123456789012345678");
+  EXPECT_S2D(12345678901234567890.0, "12345678901234567890");
+  EXPECT_S2D(1.0, "1.0000000000000000000000000000000000000000");
+  EXPECT_S2D(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+  EXPECT_S2D(3.141592653589793, "3.14159265358979323846264338327950288419716939937510");
+  EXPECT_S2D(9007199254740992.0, "9007199254740993");
+  EXPECT_S2D(9007199254740994.0, "9007199254740993.0000000000000000000000000000000000000001");
+  EXPECT_S2D(9007199254740996.0, "9007199254740995");
+  EXPECT_S2D(1.2345678901234568e-22, "0.000000000000000000000123456789012345678901234567890");
+  EXPECT_S2D(1.7976931348623157e308, "179769313486231570000000000000000000000000000000000e258");
+  // Mantissas with 19 digits just above 1e-324 drop their last digit, because the table of
+  // inverse powers of 5 ends at 5^341.
+  EXPECT_S2D(5e-324, "2500000000000000001e-342");
+  EXPECT_S2D(0.0, "2470328229206232720e-342");
+}
+
+TEST(S2dTest, LongInputsHalfway) {
+  // Exactly halfway between 1 and the next double, which rounds to even; anything above rounds up.
+  EXPECT_S2D(1.0, "1.00000000000000011102230246251565404236316680908203125");
+  EXPECT_S2D(1.0000000000000002, "1.000000000000000111022302462515654042363166809082031250000000001");
+  EXPECT_S2D(1.0, "1.000000000000000111022302462515654042363166809082031249999999999");
+  // Halfway between the smallest subnormal and zero, which has 752 significant digits.
+  const std::string half_min = "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125";
+  EXPECT_S2D(0.0, (half_min + "e-324").c_str());
+  EXPECT_S2D(5e-324, (half_min + "1e-324").c_str());
+  // Halfway between DBL_MAX and 2^1024, which rounds to infinity.
+  EXPECT_S2D(1.7976931348623157e308, "179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497791.9999999999");
+  EXPECT_S2D(INFINITY, "179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497792");
+}
+
+static enum Status s2d_grouped(const char* buffer, const ryu_separators& separators, double* value) {
+  return s2d_grouped_n(buffer, (int) strlen(buffer), &separators, value);
+}
+
+#define EXPECT_S2D_GROUPED(a, b, c) do { double value; EXPECT_EQ(SUCCESS, s2d_grouped(c, b, &value)); EXPECT_EQ(a, value); } while (0);
+
+TEST(S2dTest, Grouped) {
+  const ryu_separators comma = { ',', 3, '.' };
+  const ryu_separators dot = { '.', 3, ',' };
+  EXPECT_S2D_GROUPED(1234567.89, comma, "1,234,567.89");
+  EXPECT_S2D_GROUPED(1234567.89, dot, "1.234.567,89");
+  EXPECT_S2D_GROUPED(-1234567.89, dot, "-1.234.567,89");
+  EXPECT_S2D_GROUPED(1234567.89, comma, "1234567.89");
+  EXPECT_S2D_GROUPED(123.0, comma, "123");
+  EXPECT_S2D_GROUPED(0.5, dot, ",5");
+  EXPECT_S2D_GROUPED(1.5e6, dot, "1,5e6");
+  EXPECT_S2D_GROUPED(12345.0, comma, "12,345e0");
+  EXPECT_S2D_GROUPED(1234567.0, comma, "1,234,567.");
+  EXPECT_S2D_GROUPED(12345678.0, (ryu_separators{ ' ', 4, ',' }), "1234 5678");
+  EXPECT_S2D_GROUPED(1.5, (ryu_separators{ '\0', 0, ',' }), "1,5");
+}
+
+TEST(S2dTest, GroupedBadInput) {
+  const ryu_separators comma = { ',', 3, '.' };
+  const ryu_separators dot = { '.', 3, ',' };
+  double value;
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped(",123", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1234,567", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,23", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,2345", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,,234", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,234,", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,23.5", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1.234,567.8", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("0.123,456", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1e1,000", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,234.5", dot, &value));
+  // Without grouping, the default decimal separator is just another character.
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1.5", (ryu_separators{ '\0', 0, ',' }), &value));
+  // A group size of 0 also means no grouping.
+  EXPECT_S2D_GROUPED(1234567.5, (ryu_separators{ ',', 0, '.' }), "1234567.5");
+  EXPECT_EQ(MALFORMED_INPUT, s2d_grouped("1,234,567.5", (ryu_separators{ ',', 0, '.' }), &value));
+}
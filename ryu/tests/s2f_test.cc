@@ -16,6 +16,7 @@
 // KIND, either express or implied.
 
 #include <math.h>
+#include <string.h>
 
 #include "ryu/ryu_parse.h"
 #include "third_party/gtest/gtest.h"
@@ -53,3 +54,57 @@ TEST(S2fTest, TrailingZeros) {
   EXPECT_S2F(50000004.0f, "50000002.5");
   EXPECT_S2F(99999992.0f, "99999989.5");
 }
+
+TEST(S2fTest, LongInputs) {
+  EXPECT_S2F(1.0f, "1.0000000000000000000000000000000000000000");
+  EXPECT_S2F(0.1f, "0.1000000000000000055511151231257827021181583404541015625");
+  EXPECT_S2F(16777216.0f, "16777217.0000000000000000000000000000000000000000");
+  EXPECT_S2F(16777218.0f, "16777217.0000000000000000000000000000000000000001");
+  EXPECT_S2F(16777220.0f, "16777219.0000000000000000000000000000000000000000");
+  EXPECT_S2F(16777218.0f, "16777218.9999999999999999999999999999999999999999");
+  EXPECT_S2F(-3.14159274f, "-3.14159265358979323846264338327950288419716939937510");
+  EXPECT_S2F(123456792.0f, "123456789012345678901234567890e-21");
+  EXPECT_S2F(0.0f, "0.000000000000000000000000000000000000000000000000123456789012345");
+}
+
+TEST(S2fTest, LongInputsHalfway) {
+  // Exactly halfway between 1 and the next float, which rounds to even; anything above rounds up.
+  EXPECT_S2F(1.0f, "1.000000059604644775390625");
+  EXPECT_S2F(1.00000012f, "1.000000059604644775390625000000000000000000001");
+  EXPECT_S2F(1.0f, "1.000000059604644775390624999999999999999999999");
+  // Halfway between the smallest subnormal and zero.
+  EXPECT_S2F(0.0f, "7.00649232162408535461864791644958065640130970938257885878534141944895541342930300743319094181060791015625e-46");
+  EXPECT_S2F(1e-45f, "7.006492321624085354618647916449580656401309709382578858785341419448955413429303007433190941810607910156251e-46");
+  // Halfway between FLT_MAX and 2^128, which rounds to infinity.
+  EXPECT_S2F(FLT_MAX, "340282356779733661637539395458142568447.9999999999");
+  EXPECT_S2F(INFINITY, "340282356779733661637539395458142568448");
+  EXPECT_S2F(INFINITY, "340282356779733661637539395458142568448.0000000001");
+}
+
+static enum Status s2f_grouped(const char* buffer, const ryu_separators& separators, float* value) {
+  return s2f_grouped_n(buffer, (int) strlen(buffer), &separators, value);
+}
+
+#define EXPECT_S2F_GROUPED(a, b, c) do { float value; EXPECT_EQ(SUCCESS, s2f_grouped(c, b, &value)); EXPECT_EQ(a, value); } while (0);
+
+TEST(S2fTest, Grouped) {
+  const ryu_separators comma = { ',', 3, '.' };
+  const ryu_separators dot = { '.', 3, ',' };
+  EXPECT_S2F_GROUPED(1234567.875f, comma, "1,234,567.875");
+  EXPECT_S2F_GROUPED(-1234567.875f, dot, "-1.234.567,875");
+  EXPECT_S2F_GROUPED(0.5f, dot, "0,5");
+  // Inputs with more than 9 significant digits, which may need the exact comparison.
+  EXPECT_S2F_GROUPED(16777216.0f, comma, "16,777,217.0000000000000000000000000000000000000000");
+  EXPECT_S2F_GROUPED(16777218.0f, comma, "16,777,217.0000000000000000000000000000000000000001");
+  EXPECT_S2F_GROUPED(16777218.0f, dot, "16.777.217,0000000000000000000000000000000000000001");
+  EXPECT_S2F_GROUPED(FLT_MAX, comma, "340,282,356,779,733,661,637,539,395,458,142,568,447.9999999999");
+  EXPECT_S2F_GROUPED(INFINITY, comma, "340,282,356,779,733,661,637,539,395,458,142,568,448");
+
+  float value;
+  EXPECT_EQ(MALFORMED_INPUT, s2f_grouped("12,34", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2f_grouped("1,234.5,6", comma, &value));
+  EXPECT_EQ(MALFORMED_INPUT, s2f_grouped("1.2345", dot, &value));
+  // A group size of 0 means no grouping.
+  EXPECT_S2F_GROUPED(1234567.5f, (ryu_separators{ ',', 0, '.' }), "1234567.5");
+  EXPECT_EQ(MALFORMED_INPUT, s2f_grouped("1,234,567.5", (ryu_separators{ ',', 0, '.' }), &value));
+}
@@ -38,6 +38,10 @@ public final class PrintPrintfLookupTable {
   private static final BigInteger mask = BigInteger.valueOf(1).shiftLeft(64).subtract(BigInteger.ONE);
 
   public static void main(String[] args) {
+    if (args.length > 0 && args[0].equals("-small")) {
+      printSmallTables();
+      return;
+    }
     printTables();
     printInverseTables();
   }
@@ -173,6 +177,115 @@ public final class PrintPrintfLookupTable {
     System.out.println("};");
   }
 
+  /**
+   * Prints the tables for d2fixed_small_table.h, from which computePow10Split and
+   * computePow10Split2 reconstruct the entries of POW10_SPLIT and POW10_SPLIT_2.
+   */
+  private static void printSmallTables() {
+    BigInteger pow5_9 = BigInteger.valueOf(5).pow(9);
+    int maxBits = pow10BitsForIndex(TABLE_SIZE - 1);
+
+    // floor(2^maxBits / 10^(9 * i)) for every block i used by POW10_SPLIT.
+    int maxLen = lengthForIndex(TABLE_SIZE - 1);
+    List<BigInteger> bits = new ArrayList<>();
+    int[] bitsOffset = new int[maxLen + 1];
+    for (int i = 0; i < maxLen; i++) {
+      bitsOffset[i] = bits.size();
+      BigInteger v = BigInteger.ONE.shiftLeft(maxBits).divide(BigInteger.TEN.pow(9 * i));
+      for (; v.signum() != 0; v = v.shiftRight(64)) {
+        bits.add(v.and(mask));
+      }
+    }
+    bitsOffset[maxLen] = bits.size();
+
+    // The bits above the low 145 bits, mod 5^9, for every fourth index.
+    List<BigInteger> high = new ArrayList<>();
+    int[] highOffset = new int[TABLE_SIZE / 4 + 1];
+    for (int a = 0; a < TABLE_SIZE / 4; a++) {
+      highOffset[a] = high.size();
+      int idx = 4 * a;
+      int len = lengthForIndex(Math.min(idx + 3, TABLE_SIZE - 1));
+      for (int i = 0; i < len; i++) {
+        BigInteger v = BigInteger.ONE.shiftLeft(maxBits).divide(BigInteger.TEN.pow(9 * i))
+            .shiftRight(maxBits - pow10BitsForIndex(idx) + BITS + 9);
+        high.add(v.mod(pow5_9));
+      }
+    }
+    highOffset[TABLE_SIZE / 4] = high.size();
+
+    // 5^(36 * a) mod 2^(64 * n), with n large enough for every entry of POW10_SPLIT_2 with
+    // i / 4 == a, i.e., for w = 16 * (idx + 1) - 9 * i.
+    BigInteger lowerCutoff = BigInteger.ONE.shiftLeft(54 + 8);
+    int k = ADDITIONAL_BITS_2;
+    List<Integer> maxW = new ArrayList<>();
+    for (int idx = 0; idx < TABLE_SIZE_2; idx++) {
+      boolean started = false;
+      for (int i = 0; ; i++) {
+        BigInteger v = BigInteger.TEN.pow(9 * (i + 1))
+            .shiftRight(-(k - 16 * idx))
+            .mod(BigInteger.TEN.pow(9).shiftLeft(k + 16));
+        if (!started && v.multiply(lowerCutoff).shiftRight(128).equals(BigInteger.ZERO)) {
+          continue;
+        }
+        started = true;
+        if (v.equals(BigInteger.ZERO)) {
+          break;
+        }
+        int w = 16 * (idx + 1) - 9 * i;
+        while (maxW.size() <= i / 4) {
+          maxW.add(Integer.valueOf(0));
+        }
+        maxW.set(i / 4, Integer.valueOf(Math.max(maxW.get(i / 4).intValue(), w)));
+      }
+    }
+    List<BigInteger> anchors = new ArrayList<>();
+    int[] anchorsOffset = new int[maxW.size() + 1];
+    for (int a = 0; a < maxW.size(); a++) {
+      anchorsOffset[a] = anchors.size();
+      int n = (maxW.get(a).intValue() + 63) / 64;
+      BigInteger v = BigInteger.valueOf(5).pow(36 * a).mod(BigInteger.ONE.shiftLeft(64 * n));
+      for (int j = 0; j < n; j++) {
+        anchors.add(v.shiftRight(64 * j).and(mask));
+      }
+    }
+    anchorsOffset[maxW.size()] = anchors.size();
+
+    printOffsets("POW10_SPLIT_BITS_OFFSET", bitsOffset);
+    printRows("uint64_t", "POW10_SPLIT_BITS", bits, bitsOffset, 3, 20);
+    printOffsets("POW10_SPLIT_HIGH_OFFSET", highOffset);
+    printRows("uint32_t", "POW10_SPLIT_HIGH", high, highOffset, 8, 7);
+    printOffsets("POW10_SPLIT_2_ANCHORS_OFFSET", anchorsOffset);
+    printRows("uint64_t", "POW10_SPLIT_2_ANCHORS", anchors, anchorsOffset, 3, 20);
+  }
+
+  private static void printOffsets(String name, int[] offsets) {
+    System.out.println("static const uint16_t " + name + "[" + offsets.length + "] = {");
+    for (int i = 0; i < offsets.length; i++) {
+      System.out.print(i % 10 == 0 ? "  " : " ");
+      System.out.printf("%4d%s", Integer.valueOf(offsets[i]),
+          i == offsets.length - 1 ? "\n" : (i % 10 == 9 ? ",\n" : ","));
+    }
+    System.out.println("};");
+    System.out.println();
+  }
+
+  // Prints the values with at most perRow values per line, starting a new line at every offset.
+  private static void printRows(
+      String type, String name, List<BigInteger> values, int[] offsets, int perRow, int width) {
+    System.out.println("static const " + type + " " + name + "[" + values.size() + "] = {");
+    for (int g = 0; g + 1 < offsets.length; g++) {
+      for (int i = offsets[g]; i < offsets[g + 1]; i++) {
+        int column = (i - offsets[g]) % perRow;
+        boolean endOfRow = column == perRow - 1 || i == offsets[g + 1] - 1;
+        System.out.print(column == 0 ? "  " : " ");
+        System.out.printf("%" + width + "su", values.get(i));
+        System.out.print(i == values.size() - 1 ? "\n" : (endOfRow ? ",\n" : ","));
+      }
+    }
+    System.out.println("};");
+    System.out.println();
+  }
+
   private static int pow10BitsForIndex(int idx) {
     return 16 * idx + POW10_ADDITIONAL_BITS;
   }